@@ -0,0 +1,22 @@
+#pragma once
+
+#include <string>
+
+namespace Bench
+{
+    struct Program
+    {
+        std::string Source;
+        // name of the function the benchmarks call, for the chains it transitively calls every generated function
+        std::string Entry;
+    };
+
+    // a chain of many small kaleidoscope functions, each one calling the previous one
+    Program GenerateFunctions(size_t count);
+    // functions with a single expression, nested 'depth' levels deep
+    Program GenerateNestedExpressions(size_t count, size_t depth);
+    // the smallest possible functions, each one only calling the previous one
+    Program GenerateCallChain(size_t length);
+    // functions adding up 64 literals each, in every notation the lexer knows
+    Program GenerateLiterals(size_t count);
+}
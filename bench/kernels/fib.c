@@ -0,0 +1,4 @@
+double fib(double x)
+{
+    return x < 3 ? 1 : fib(x - 1) + fib(x - 2);
+}
@@ -0,0 +1,24 @@
+static double mandel_iter(double cr, double ci, double zr, double zi, double i)
+{
+    if (i < 256)
+    {
+        if (zr * zr + zi * zi > 4) return i;
+        return mandel_iter(cr, ci, zr * zr - zi * zi + cr, 2 * zr * zi + ci, i + 1);
+    }
+    return i;
+}
+
+static double mandel_row(double x, double y, double n, double acc)
+{
+    return x < n ? mandel_row(x + 1, y, n, acc + mandel_iter(x / n * 3 - 2, y / n * 2 - 1, 0, 0, 0)) : acc;
+}
+
+static double mandel_rows(double y, double n, double acc)
+{
+    return y < n ? mandel_rows(y + 1, n, mandel_row(0, y, n, acc)) : acc;
+}
+
+double mandel(double n)
+{
+    return mandel_rows(0, n, 0);
+}
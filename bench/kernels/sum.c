@@ -0,0 +1,9 @@
+static double sum_loop(double i, double n, double acc)
+{
+    return i < n ? sum_loop(i + 1, n, acc + i * 0.5) : acc;
+}
+
+double sum(double n)
+{
+    return sum_loop(0, n, 0);
+}
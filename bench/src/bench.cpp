@@ -0,0 +1,174 @@
+#include <chrono>
+#include <iostream>
+#include <sstream>
+#include <vector>
+#include <Bench/Generate.hpp>
+#include <Brewer/AST.hpp>
+#include <Brewer/Builder.hpp>
+#include <Brewer/Context.hpp>
+#include <Brewer/Parser.hpp>
+#include <Brewer/Type.hpp>
+#include <Test/AST.hpp>
+#include <Test/Frontend.hpp>
+
+using namespace Brewer;
+
+static double to_ms(const Timing::Clock::duration duration)
+{
+    return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+static double per_second(const size_t count, const double ms)
+{
+    return ms > 0 ? static_cast<double>(count) * 1000 / ms : 0;
+}
+
+static size_t lex(const Bench::Program& program, double& ms)
+{
+    Context context;
+    Builder builder(context, "bench", "bench.k");
+    std::istringstream stream(program.Source);
+
+    const auto start = Timing::Clock::now();
+    Parser parser(builder, stream, "bench.k");
+    size_t tokens = 0;
+    for (; !parser.AtEOF(); parser.Next())
+        ++tokens;
+    ms = to_ms(Timing::Clock::now() - start);
+
+    return tokens;
+}
+
+// the nodes the parser actually produced, statements included, so folded expressions do not count
+static size_t count_nodes(const Statement* statement)
+{
+    if (!statement) return 0;
+
+    size_t nodes = 1;
+    if (const auto def = dynamic_cast<const Test::DefStatement*>(statement))
+        nodes += count_nodes(def->Body.get());
+    else if (const auto if_ = dynamic_cast<const Test::IfExpression*>(statement))
+        nodes += count_nodes(if_->Condition.get()) + count_nodes(if_->Then.get()) + count_nodes(if_->Else.get());
+    else if (const auto binary = dynamic_cast<const BinaryExpression*>(statement))
+        nodes += count_nodes(binary->LHS.get()) + count_nodes(binary->RHS.get());
+    else if (const auto unary = dynamic_cast<const UnaryExpression*>(statement))
+        nodes += count_nodes(unary->Operand.get());
+    else if (const auto call = dynamic_cast<const CallExpression*>(statement))
+    {
+        nodes += count_nodes(call->Callee.get());
+        for (const auto& arg : call->Args)
+            nodes += count_nodes(arg.get());
+    }
+    else if (const auto index = dynamic_cast<const IndexExpression*>(statement))
+        nodes += count_nodes(index->Base.get()) + count_nodes(index->Index.get());
+    else if (const auto member = dynamic_cast<const MemberExpression*>(statement))
+        nodes += count_nodes(member->Object.get());
+    return nodes;
+}
+
+// lexer, parser, ir generation and emission of one generated program, as one json object per line
+static void run(const std::string& workload, const size_t size, const Bench::Program& program)
+{
+    double lex_ms;
+    const auto tokens = lex(program, lex_ms);
+
+    Timing timing;
+    Context context;
+    Builder builder(context, "bench", "bench.k");
+    builder.SetTiming(&timing);
+    std::istringstream stream(program.Source);
+    Parser parser(builder, stream, "bench.k");
+    Test::Register(parser);
+
+    size_t nodes = 0;
+    while (!parser.AtEOF())
+    {
+        StmtPtr ptr;
+        {
+            PhaseScope phase(&timing, Phase_Parse);
+            ptr = parser.Parse();
+        }
+        if (!ptr) continue;
+        nodes += count_nodes(ptr.get());
+
+        PhaseScope phase(&timing, Phase_IRGen);
+        builder.IRBuilder().SetInsertPoint(&builder.GetGlobalCtor()->back());
+        ptr->GenIRNoVal(builder);
+    }
+    builder.CloseGlobals();
+
+    size_t instructions = 0;
+    for (const auto& function : builder.IRModule())
+        instructions += function.getInstructionCount();
+
+    llvm::SmallVector<char, 0> buffer;
+    builder.EmitToBuffer(buffer, OutputKind_Object);
+
+    // the parse phase includes the lexer, it is measured on its own above
+    const auto parse_ms = to_ms(timing.Get(Phase_Parse) + timing.Get(Phase_Lex));
+    const auto irgen_ms = to_ms(timing.Get(Phase_IRGen));
+    const auto emit_ms = to_ms(timing.Get(Phase_Codegen));
+
+    std::cout
+        << "{\"benchmark\":\"frontend\""
+        << ",\"workload\":\"" << workload << "\""
+        << ",\"size\":" << size
+        << ",\"bytes\":" << program.Source.size()
+        << ",\"tokens\":" << tokens
+        << ",\"lex_ms\":" << lex_ms
+        << ",\"tokens_per_sec\":" << per_second(tokens, lex_ms)
+        << ",\"nodes\":" << nodes
+        << ",\"parse_ms\":" << parse_ms
+        << ",\"nodes_per_sec\":" << per_second(nodes, parse_ms)
+        << ",\"instructions\":" << instructions
+        << ",\"irgen_ms\":" << irgen_ms
+        << ",\"instructions_per_sec\":" << per_second(instructions, irgen_ms)
+        << ",\"emit_ms\":" << emit_ms
+        << ",\"object_bytes\":" << buffer.size()
+        << "}" << std::endl;
+}
+
+// the toy language has no aggregates, so large structs go through the type api directly
+static void run_structs(const size_t fields)
+{
+    Context context;
+    Builder builder(context, "bench", "bench.k");
+
+    const auto start = Timing::Clock::now();
+    std::vector<StructElement> elements;
+    for (size_t i = 0; i < fields; ++i)
+    {
+        auto type = i % 3 == 0
+                        ? context.GetFloat64Ty()
+                        : i % 3 == 1
+                        ? context.GetInt32Ty()
+                        : ArrayType::Get(context.GetInt8Ty(), i % 16 + 1);
+        elements.emplace_back(type, "e" + std::to_string(i));
+    }
+    const auto type = StructType::Get(elements);
+    const auto create_ms = to_ms(Timing::Clock::now() - start);
+
+    const auto lower = Timing::Clock::now();
+    const auto ir = type->GenIR(builder);
+    const auto lower_ms = to_ms(Timing::Clock::now() - lower);
+
+    std::cout
+        << "{\"benchmark\":\"struct_type\""
+        << ",\"size\":" << fields
+        << ",\"create_ms\":" << create_ms
+        << ",\"lower_ms\":" << lower_ms
+        << ",\"ir_elements\":" << (ir ? ir->getNumElements() : 0)
+        << "}" << std::endl;
+}
+
+int main(const int argc, const char** argv)
+{
+    const size_t scale = argc > 1 ? std::stoull(argv[1]) : 1;
+
+    run("functions", 10000 * scale, Bench::GenerateFunctions(10000 * scale));
+    run("nested_expressions", 100 * scale, Bench::GenerateNestedExpressions(100 * scale, 200));
+    run("call_chain", 20000 * scale, Bench::GenerateCallChain(20000 * scale));
+    run("literals", 50000 * scale, Bench::GenerateLiterals(50000 * scale));
+    run_structs(1000 * scale);
+    return 0;
+}
@@ -0,0 +1,71 @@
+#include <sstream>
+#include <Bench/Generate.hpp>
+
+Bench::Program Bench::GenerateFunctions(const size_t count)
+{
+    std::stringstream source;
+    source << "def f0(x) x + 1" << std::endl;
+    for (size_t i = 1; i < count; ++i)
+        source
+            << "def f" << i << "(x) "
+            << "if x < " << i % 7 << " then f" << i - 1 << "(x + 1) "
+            << "else x * " << i % 13 << " - f" << i - 1 << "(x - 1)"
+            << std::endl;
+    return {source.str(), "f" + std::to_string(count ? count - 1 : 0)};
+}
+
+Bench::Program Bench::GenerateNestedExpressions(const size_t count, const size_t depth)
+{
+    static const char operators[] = {'+', '*', '-', '/'};
+
+    std::stringstream source;
+    for (size_t i = 0; i < count; ++i)
+    {
+        source << "def n" << i << "(x) ";
+        for (size_t d = 0; d < depth; ++d)
+            source << "(x " << operators[d % 4] << ' ';
+        source << "1.5";
+        for (size_t d = 0; d < depth; ++d)
+            source << ')';
+        source << std::endl;
+    }
+    return {source.str(), "n0"};
+}
+
+Bench::Program Bench::GenerateCallChain(const size_t length)
+{
+    std::stringstream source;
+    source << "def c0(x) x" << std::endl;
+    for (size_t i = 1; i < length; ++i)
+        source << "def c" << i << "(x) c" << i - 1 << "(x) + 1" << std::endl;
+    return {source.str(), "c" + std::to_string(length ? length - 1 : 0)};
+}
+
+Bench::Program Bench::GenerateLiterals(const size_t count)
+{
+    constexpr size_t per_function = 64;
+
+    std::stringstream source;
+    for (size_t i = 0; i * per_function < count; ++i)
+    {
+        source << "def l" << i << "(x) x";
+        for (size_t j = i * per_function; j < count && j < (i + 1) * per_function; ++j)
+        {
+            switch (j % 5)
+            {
+            case 0: source << " + " << j;
+                break;
+            case 1: source << " + " << j << ".25";
+                break;
+            case 2: source << " + 0x" << std::hex << j << std::dec;
+                break;
+            case 3: source << " + 0" << std::oct << j << std::dec;
+                break;
+            default: source << " + 0.5";
+                break;
+            }
+        }
+        source << std::endl;
+    }
+    return {source.str(), "l0"};
+}
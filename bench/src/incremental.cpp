@@ -0,0 +1,91 @@
+#include <chrono>
+#include <iostream>
+#include <sstream>
+#include <Bench/Generate.hpp>
+#include <Brewer/Pipeline.hpp>
+#include <llvm/Support/FileSystem.h>
+#include <Test/Frontend.hpp>
+
+using namespace Brewer;
+
+static double run(Pipeline& pipeline, const std::string& source)
+{
+    std::istringstream stream(source);
+
+    const auto start = std::chrono::steady_clock::now();
+    pipeline.BuildToBuffer(stream, "bench.k", OutputKind_Bitcode);
+    const auto end = std::chrono::steady_clock::now();
+
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+static double run_object(Pipeline& pipeline, const std::string& source, const std::string& output)
+{
+    std::istringstream stream(source);
+
+    const auto start = std::chrono::steady_clock::now();
+    pipeline.BuildAndEmit(stream, "bench.k", output);
+    const auto end = std::chrono::steady_clock::now();
+
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+// rebuild time after changing a single function, compared to the first build of the same program
+int main(const int argc, const char** argv)
+{
+    const size_t functions = argc > 1 ? std::stoull(argv[1]) : 10000;
+    const unsigned level = argc > 2 ? std::stoul(argv[2]) : 2;
+
+    const auto program = Bench::GenerateFunctions(functions);
+
+    // change the body of the function in the middle, its signature stays the same
+    auto edited = program.Source;
+    const auto name = "def f" + std::to_string(functions / 2) + "(x) ";
+    if (const auto pos = edited.find(name); pos != std::string::npos)
+        edited.insert(pos + name.size(), "1 + ");
+
+    Pipeline pipeline;
+    Test::Register(pipeline).ModuleID("bench").Optimize(level).Streaming(true).Incremental(true);
+
+    const auto cold = run(pipeline, program.Source);
+    const auto unchanged = run(pipeline, program.Source);
+    const auto changed = run(pipeline, edited);
+
+    const auto [Hits, Misses, FragmentHits, FragmentMisses] = pipeline.GetCompileCacheStatistics();
+
+    // the same edit with object code output, where only the partitions of the changed function are regenerated
+    llvm::SmallString<128> directory;
+    if (const auto ec = llvm::sys::fs::createUniqueDirectory("brewer-bench-incremental", directory))
+    {
+        std::cerr << "failed to create cache directory: " << ec.message() << std::endl;
+        return 1;
+    }
+    const auto output = (directory + "/bench.o").str();
+
+    Pipeline object_pipeline;
+    Test::Register(object_pipeline)
+        .ModuleID("bench")
+        .Optimize(level)
+        .Streaming(true)
+        .Incremental(true)
+        .IncrementalPartitions(64)
+        .CompileCache((directory + "/cache").str());
+
+    const auto object_cold = run_object(object_pipeline, program.Source, output);
+    const auto object_changed = run_object(object_pipeline, edited, output);
+    llvm::sys::fs::remove_directories(directory);
+    std::cout
+        << "{\"benchmark\":\"incremental\""
+        << ",\"functions\":" << functions
+        << ",\"opt_level\":" << level
+        << ",\"cold_ms\":" << cold
+        << ",\"unchanged_ms\":" << unchanged
+        << ",\"changed_ms\":" << changed
+        << ",\"object_cold_ms\":" << object_cold
+        << ",\"object_changed_ms\":" << object_changed
+        << ",\"fragment_hits\":" << FragmentHits
+        << ",\"fragment_misses\":" << FragmentMisses
+        << ",\"streaming_fallbacks\":" << pipeline.GetStreamingFallbacks()
+        << "}" << std::endl;
+    return 0;
+}
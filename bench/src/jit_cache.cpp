@@ -0,0 +1,62 @@
+#include <chrono>
+#include <iostream>
+#include <sstream>
+#include <Bench/Generate.hpp>
+#include <Brewer/JIT.hpp>
+#include <Brewer/Pipeline.hpp>
+#include <llvm/Support/FileSystem.h>
+#include <Test/Frontend.hpp>
+
+using namespace Brewer;
+
+static double run(const Bench::Program& program, const std::string& directory, size_t& hits)
+{
+    const auto start = std::chrono::steady_clock::now();
+
+    Pipeline pipeline;
+    Test::Register(pipeline).ModuleID("bench").JITCache(directory);
+
+    std::istringstream stream(program.Source);
+    const auto jit = pipeline.BuildAndJIT(stream, "bench.k");
+    if (!jit) return -1;
+
+    // looking up the entry materializes the whole module
+    const auto entry = jit->Lookup<double(double)>(program.Entry);
+    if (!entry) return -1;
+    entry(0);
+
+    const auto end = std::chrono::steady_clock::now();
+    hits = jit->GetObjectCache()->GetCache().GetHits();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+// cold vs. warm startup of the jit with a persistent object cache
+int main(const int argc, const char** argv)
+{
+    if (argc < 2)
+    {
+        std::cerr << "USAGE: brewer-bench-jit-cache <cache directory> [functions]" << std::endl;
+        return 1;
+    }
+
+    const std::string directory = argv[1];
+    const size_t functions = argc > 2 ? std::stoull(argv[2]) : 10000;
+
+    llvm::sys::fs::remove_directories(directory);
+
+    const auto program = Bench::GenerateFunctions(functions);
+
+    size_t cold_hits, warm_hits;
+    const auto cold = run(program, directory, cold_hits);
+    const auto warm = run(program, directory, warm_hits);
+    if (cold < 0 || warm < 0) return 1;
+
+    std::cout
+        << "{\"benchmark\":\"jit_cache\""
+        << ",\"functions\":" << functions
+        << ",\"cold_ms\":" << cold
+        << ",\"warm_ms\":" << warm
+        << ",\"warm_hits\":" << warm_hits
+        << "}" << std::endl;
+    return 0;
+}
@@ -0,0 +1,66 @@
+#include <chrono>
+#include <iostream>
+#include <sstream>
+#include <Bench/Generate.hpp>
+#include <Brewer/Pipeline.hpp>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/Path.h>
+#include <Test/Frontend.hpp>
+
+using namespace Brewer;
+
+static double run(const Bench::Program& program, const std::string& output, const unsigned threads)
+{
+    Pipeline pipeline;
+    Test::Register(pipeline).ModuleID("bench").Threads(threads);
+    if (!output.empty()) pipeline.Emit(OutputKind_Object, output);
+
+    std::istringstream stream(program.Source);
+
+    const auto start = std::chrono::steady_clock::now();
+    pipeline.Build(stream, "bench.k");
+    const auto end = std::chrono::steady_clock::now();
+
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+// wall time of object emission for an increasing number of codegen threads
+int main(const int argc, const char** argv)
+{
+    if (argc < 2)
+    {
+        std::cerr << "USAGE: brewer-bench-parallel <output directory> [functions] [max threads]" << std::endl;
+        return 1;
+    }
+
+    const std::string directory = argv[1];
+    const size_t functions = argc > 2 ? std::stoull(argv[2]) : 50000;
+    const unsigned max_threads = argc > 3 ? std::stoul(argv[3]) : 8;
+
+    llvm::sys::fs::create_directories(directory);
+
+    llvm::SmallString<128> output(directory);
+    llvm::sys::path::append(output, "bench.o");
+
+    const auto program = Bench::GenerateFunctions(functions);
+
+    // the front end does not change with the thread count, so it is measured once and taken out
+    const auto frontend = run(program, {}, 1);
+
+    double baseline = 0;
+    for (unsigned threads = 1; threads <= max_threads; threads *= 2)
+    {
+        const auto codegen = run(program, output.str().str(), threads) - frontend;
+        if (threads == 1) baseline = codegen;
+
+        std::cout
+            << "{\"benchmark\":\"parallel_codegen\""
+            << ",\"functions\":" << functions
+            << ",\"threads\":" << threads
+            << ",\"frontend_ms\":" << frontend
+            << ",\"codegen_ms\":" << codegen
+            << ",\"speedup\":" << baseline / codegen
+            << "}" << std::endl;
+    }
+    return 0;
+}
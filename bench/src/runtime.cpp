@@ -0,0 +1,161 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <optional>
+#include <Brewer/JIT.hpp>
+#include <Brewer/Pipeline.hpp>
+#include <llvm/Support/DynamicLibrary.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/Path.h>
+#include <llvm/Support/Program.h>
+#include <Test/Frontend.hpp>
+
+#ifndef BENCH_KERNEL_DIR
+#define BENCH_KERNEL_DIR "bench/kernels"
+#endif
+
+#if defined(_WIN32)
+#define BENCH_SHARED_EXT ".dll"
+#elif defined(__APPLE__)
+#define BENCH_SHARED_EXT ".dylib"
+#else
+#define BENCH_SHARED_EXT ".so"
+#endif
+
+using namespace Brewer;
+
+typedef double (*KernelFn)(double);
+
+struct Kernel
+{
+    std::string Name;
+    std::string Entry;
+    double Arg;
+};
+
+// best of a few runs, in milliseconds
+static double measure(const KernelFn fn, const double arg, double& result)
+{
+    double best = INFINITY;
+    for (unsigned i = 0; i < 5; ++i)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        result = fn(arg);
+        const auto end = std::chrono::steady_clock::now();
+        best = std::min(best, std::chrono::duration<double, std::milli>(end - start).count());
+    }
+    return best;
+}
+
+static std::unique_ptr<JIT> build_brewer(const std::string& directory, const Kernel& kernel, const unsigned level)
+{
+    llvm::SmallString<128> path(directory);
+    llvm::sys::path::append(path, kernel.Name + ".k");
+
+    std::ifstream stream(path.str().str());
+    if (!stream)
+    {
+        std::cerr << "failed to open '" << path.str().str() << "'" << std::endl;
+        return {};
+    }
+
+    Pipeline pipeline;
+    Test::Register(pipeline).ModuleID(kernel.Name).Optimize(level);
+    return pipeline.BuildAndJIT(stream, path.str().str());
+}
+
+static KernelFn build_clang(const std::string& clang,
+                            const std::string& directory,
+                            const std::string& output_directory,
+                            const Kernel& kernel,
+                            const unsigned level)
+{
+    llvm::SmallString<128> source(directory);
+    llvm::sys::path::append(source, kernel.Name + ".c");
+    llvm::SmallString<128> output(output_directory);
+    llvm::sys::path::append(output, kernel.Name + ".O" + std::to_string(level) + BENCH_SHARED_EXT);
+
+    // brewer never contracts floating point operations, so clang must not either
+    const std::string opt = "-O" + std::to_string(level);
+    const llvm::StringRef args[]{
+        clang, opt, "-ffp-contract=off", "-shared", "-fPIC", "-o", output.str(), source.str(),
+    };
+
+    std::string error;
+    if (llvm::sys::ExecuteAndWait(clang, args, std::nullopt, {}, 0, 0, &error))
+    {
+        std::cerr << "failed to compile '" << source.str().str() << "': " << error << std::endl;
+        return {};
+    }
+
+    auto library = llvm::sys::DynamicLibrary::getPermanentLibrary(output.c_str(), &error);
+    if (!library.isValid())
+    {
+        std::cerr << "failed to load '" << output.str().str() << "': " << error << std::endl;
+        return {};
+    }
+    return reinterpret_cast<KernelFn>(library.getAddressOfSymbol(kernel.Entry.c_str()));
+}
+
+// runtime of the code brewer generates for each kernel, relative to the same kernel in c compiled by clang
+int main(const int argc, const char** argv)
+{
+    const unsigned level = argc > 1 ? std::stoul(argv[1]) : 2;
+    const std::string directory = argc > 2 ? argv[2] : BENCH_KERNEL_DIR;
+
+    const auto clang = llvm::sys::findProgramByName("clang");
+    if (!clang)
+    {
+        std::cerr << "clang not found: " << clang.getError().message() << std::endl;
+        return 1;
+    }
+
+    llvm::SmallString<128> output_directory;
+    if (const auto ec = llvm::sys::fs::createUniqueDirectory("brewer-bench-runtime", output_directory))
+    {
+        std::cerr << "failed to create output directory: " << ec.message() << std::endl;
+        return 1;
+    }
+
+    const Kernel kernels[]{
+        {"fib", "fib", 32},
+        // the tail recursion of sum only runs in constant stack space from -O1 on, below that it is scaled down
+        // so neither side overflows the stack
+        {"sum", "sum", level ? 1e7 : 1e4},
+        {"mandel", "mandel", 400},
+    };
+
+    int status = 0;
+    for (const auto& kernel : kernels)
+    {
+        const auto jit = build_brewer(directory, kernel, level);
+        const auto brewer_fn = jit ? jit->Lookup<double(double)>(kernel.Entry) : nullptr;
+        const auto clang_fn = build_clang(*clang, directory, output_directory.str().str(), kernel, level);
+        if (!brewer_fn || !clang_fn)
+        {
+            std::cerr << "skipping kernel '" << kernel.Name << "'" << std::endl;
+            status = 1;
+            continue;
+        }
+
+        double brewer_result, clang_result;
+        const auto brewer_ms = measure(brewer_fn, kernel.Arg, brewer_result);
+        const auto clang_ms = measure(clang_fn, kernel.Arg, clang_result);
+
+        std::cout
+            << "{\"benchmark\":\"runtime\""
+            << ",\"kernel\":\"" << kernel.Name << "\""
+            << ",\"opt_level\":" << level
+            << ",\"arg\":" << kernel.Arg
+            << ",\"brewer_ms\":" << brewer_ms
+            << ",\"clang_ms\":" << clang_ms
+            << ",\"ratio\":" << brewer_ms / clang_ms
+            << ",\"results_match\":" << (brewer_result == clang_result ? "true" : "false")
+            << "}" << std::endl;
+    }
+
+    llvm::sys::fs::remove_directories(output_directory);
+    return status;
+}
@@ -30,6 +30,8 @@ namespace Test
 
         std::ostream& Dump(std::ostream& stream) const override;
         void GenIRNoVal(Brewer::Builder& builder) const override;
+        void Declare(Brewer::Builder& builder) const override;
+        [[nodiscard]] std::string GetDefinedName() const override;
 
         Prototype Proto;
         Brewer::ExprPtr Body;
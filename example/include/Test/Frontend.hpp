@@ -0,0 +1,11 @@
+#pragma once
+
+#include <Brewer/Brewer.hpp>
+
+namespace Test
+{
+    // registers the def, extern and if parsers of the kaleidoscope toy language
+    Brewer::Pipeline& Register(Brewer::Pipeline& pipeline);
+    // the same for a parser that is driven by hand
+    Brewer::Parser& Register(Brewer::Parser& parser);
+}
@@ -1,8 +1,10 @@
 #include <iostream>
 #include <Brewer/Builder.hpp>
 #include <Brewer/Type.hpp>
+#include <Brewer/Util.hpp>
 #include <Brewer/Value.hpp>
 #include <llvm/IR/Verifier.h>
+#include <llvm/Support/raw_os_ostream.h>
 #include <Test/AST.hpp>
 
 using namespace Brewer;
@@ -48,15 +50,29 @@ void Test::DefStatement::GenIRNoVal(Builder& builder) const
     builder.IRBuilder().CreateRet(return_value->Get());
     builder.IRBuilder().SetInsertPoint(bkp);
 
-    if (verifyFunction(*fn, &llvm::errs()))
+    if (llvm::raw_os_ostream err(Err()); verifyFunction(*fn, &err))
     {
-        llvm::errs() << "-----------------------------------------------------------------\n";
-        fn->print(llvm::errs(), nullptr);
-        llvm::errs() << "-----------------------------------------------------------------\n";
+        err << "-----------------------------------------------------------------\n";
+        fn->print(err, nullptr);
+        err << "-----------------------------------------------------------------\n";
+        err.flush();
         fn->erase(fn->begin(), fn->end());
-        std::cerr
+        Err()
             << "at " << Location << ": "
             << "failed to verify function"
             << std::endl;
+        return;
     }
+
+    builder.CloseFunction(fn);
+}
+
+void Test::DefStatement::Declare(Builder& builder) const
+{
+    Proto.GenIR(builder);
+}
+
+std::string Test::DefStatement::GetDefinedName() const
+{
+    return Proto.Name;
 }
@@ -1,3 +1,4 @@
+#include <Brewer/Builder.hpp>
 #include <Brewer/Type.hpp>
 #include <Brewer/Value.hpp>
 #include <llvm/IR/Function.h>
@@ -17,5 +18,13 @@ std::ostream& Test::ExternStatement::Dump(std::ostream& stream) const
 
 void Test::ExternStatement::GenIRNoVal(Builder& builder) const
 {
+    // functions llvm has an intrinsic for, like sqrt, are called directly instead of through the library
+    const auto type = FunctionType::From(Proto.GetType(builder.GetContext())->GetBase());
+    if (auto intrinsic = builder.GetIntrinsic(Proto.Name, type))
+    {
+        builder.GetFunction({}, Proto.Name) = intrinsic;
+        return;
+    }
+
     Proto.GenIR(builder);
 }
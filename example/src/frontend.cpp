@@ -0,0 +1,97 @@
+#include <Brewer/Builder.hpp>
+#include <Brewer/Context.hpp>
+#include <Brewer/Parser.hpp>
+#include <Brewer/Pipeline.hpp>
+#include <Brewer/Type.hpp>
+#include <Brewer/Value.hpp>
+#include <Test/AST.hpp>
+#include <Test/Frontend.hpp>
+
+using namespace Brewer;
+
+static Test::Prototype parse_proto(Parser& parser)
+{
+    auto [Location, Type, Value] = parser.Expect(TokenType_Name);
+    std::vector<std::string> params;
+    parser.Expect("(");
+    while (!parser.NextIfAt(")"))
+    {
+        auto param = parser.Expect(TokenType_Name).Value;
+        params.push_back(param);
+    }
+
+    Test::Prototype proto{Value, params};
+
+    parser.GetBuilder().GetFunction({}, Value) = Value::Empty(proto.GetType(parser.GetContext()));
+    return proto;
+}
+
+static StmtPtr parse_def(Parser& parser)
+{
+    auto [Location, Type, Value] = parser.Expect("def");
+    auto proto = parse_proto(parser);
+    parser.GetBuilder().Push();
+    for (auto& param : proto.Params)
+        parser.GetBuilder().GetSymbol(param) = Value::Empty(parser.GetContext().GetFloat64Ty());
+    auto body = parser.ParseExpr();
+    parser.GetBuilder().Pop();
+    if (!body) return {};
+    return std::make_unique<Test::DefStatement>(Location, proto, std::move(body));
+}
+
+// 'export def ...' keeps the function visible, everything else becomes internal to the module
+static StmtPtr parse_export(Parser& parser)
+{
+    parser.Expect("export");
+    auto ptr = parse_def(parser);
+    if (!ptr) return {};
+    parser.GetBuilder().Export(dynamic_cast<Test::DefStatement&>(*ptr).Proto.Name);
+    return ptr;
+}
+
+static StmtPtr parse_extern(Parser& parser)
+{
+    auto [Location, Type, Value] = parser.Expect("extern");
+    auto proto = parse_proto(parser);
+    return std::make_unique<Test::ExternStatement>(Location, proto);
+}
+
+static ExprPtr parse_if(Parser& parser)
+{
+    auto [Location, Type, Value] = parser.Expect("if");
+    auto condition = parser.ParseExpr();
+    if (!condition) return {};
+    parser.Expect("then");
+    auto then = parser.ParseExpr();
+    if (!then) return {};
+    parser.Expect("else");
+    auto else_ = parser.ParseExpr();
+    if (!else_) return {};
+
+    auto type = Type::GetHigherOrder(then->Type, else_->Type);
+    if (!type) return {};
+
+    return std::make_unique<Test::IfExpression>(Location,
+                                                type,
+                                                std::move(condition),
+                                                std::move(then),
+                                                std::move(else_));
+}
+
+Pipeline& Test::Register(Pipeline& pipeline)
+{
+    return pipeline
+           .ParseStmtFn("def", parse_def)
+           .ParseStmtFn("export", parse_export)
+           .ParseStmtFn("extern", parse_extern)
+           .ParseExprFn("if", parse_if);
+}
+
+Parser& Test::Register(Parser& parser)
+{
+    parser.ParseStmtFn("def") = parse_def;
+    parser.ParseStmtFn("export") = parse_export;
+    parser.ParseStmtFn("extern") = parse_extern;
+    parser.ParseExprFn("if") = parse_if;
+    return parser;
+}
@@ -1,85 +1,85 @@
 #include <filesystem>
 #include <fstream>
-#include <Brewer/Builder.hpp>
-#include <Brewer/Context.hpp>
-#include <Brewer/Parser.hpp>
+#include <Brewer/JIT.hpp>
 #include <Brewer/Pipeline.hpp>
-#include <Brewer/Type.hpp>
-#include <Brewer/Value.hpp>
-#include <Test/AST.hpp>
+#include <Brewer/Util.hpp>
+#include <Test/Frontend.hpp>
 
 using namespace Brewer;
 
-static Test::Prototype parse_proto(Parser& parser)
+static OutputKind get_output_kind(const std::string& filename)
 {
-    auto [Location, Type, Value] = parser.Expect(TokenType_Name);
-    std::vector<std::string> params;
-    parser.Expect("(");
-    while (!parser.NextIfAt(")"))
-    {
-        auto param = parser.Expect(TokenType_Name).Value;
-        params.push_back(param);
-    }
-
-    Test::Prototype proto{Value, params};
-
-    parser.GetBuilder().GetFunction({}, Value) = Value::Empty(proto.GetType(parser.GetContext()));
-    return proto;
+    const auto extension = std::filesystem::path(filename).extension().string();
+    if (extension == ".bc") return OutputKind_Bitcode;
+    if (extension == ".ll") return OutputKind_IR;
+    if (extension == ".s") return OutputKind_Assembly;
+    return OutputKind_Object;
 }
 
-static StmtPtr parse_def(Parser& parser)
+static int run_jit(Pipeline& pipeline,
+                   std::istream& stream,
+                   const std::string& input_filename,
+                   const std::string& function,
+                   const std::vector<double>& args)
 {
-    auto [Location, Type, Value] = parser.Expect("def");
-    auto proto = parse_proto(parser);
-    parser.GetBuilder().Push();
-    for (auto& param : proto.Params)
-        parser.GetBuilder().GetSymbol(param) = Value::Empty(parser.GetContext().GetFloat64Ty());
-    auto body = parser.ParseExpr();
-    parser.GetBuilder().Pop();
-    if (!body) return {};
-    return std::make_unique<Test::DefStatement>(Location, proto, std::move(body));
-}
+    const auto jit = pipeline.BuildAndJIT(stream, input_filename);
+    if (!jit) return 1;
 
-static StmtPtr parse_extern(Parser& parser)
-{
-    auto [Location, Type, Value] = parser.Expect("extern");
-    auto proto = parse_proto(parser);
-    return std::make_unique<Test::ExternStatement>(Location, proto);
-}
-
-static ExprPtr parse_if(Parser& parser)
-{
-    auto [Location, Type, Value] = parser.Expect("if");
-    auto condition = parser.ParseExpr();
-    if (!condition) return {};
-    parser.Expect("then");
-    auto then = parser.ParseExpr();
-    if (!then) return {};
-    parser.Expect("else");
-    auto else_ = parser.ParseExpr();
-    if (!else_) return {};
+    double result;
+    switch (args.size())
+    {
+    case 0:
+        {
+            const auto fn = jit->Lookup<double()>(function);
+            if (!fn) return 1;
+            result = fn();
+        }
+        break;
+    case 1:
+        {
+            const auto fn = jit->Lookup<double(double)>(function);
+            if (!fn) return 1;
+            result = fn(args[0]);
+        }
+        break;
+    case 2:
+        {
+            const auto fn = jit->Lookup<double(double, double)>(function);
+            if (!fn) return 1;
+            result = fn(args[0], args[1]);
+        }
+        break;
+    case 3:
+        {
+            const auto fn = jit->Lookup<double(double, double, double)>(function);
+            if (!fn) return 1;
+            result = fn(args[0], args[1], args[2]);
+        }
+        break;
+    default:
+        std::cerr << "jit mode supports at most 3 arguments" << std::endl;
+        return 1;
+    }
 
-    auto type = Type::GetHigherOrder(then->Type, else_->Type);
-    if (!type) return {};
+    std::cout << function << "(" << args << ") = " << result << std::endl;
 
-    return std::make_unique<Test::IfExpression>(Location,
-                                                type,
-                                                std::move(condition),
-                                                std::move(then),
-                                                std::move(else_));
+    const auto [Modules, Functions] = jit->GetStatistics();
+    std::cerr << "compiled " << Functions << " function(s) in " << Modules << " module(s)" << std::endl;
+    return 0;
 }
 
 // small implementation of the kaleidoscope toy language
 int main(const int argc, const char** argv)
 {
-    if (argc < 3)
+    const auto jit = argc >= 3 && (std::string(argv[2]) == "--jit" || std::string(argv[2]) == "--lazy-jit");
+    if (argc < 3 || (jit && argc < 4))
     {
-        std::cerr << "USAGE: test <in> <out>" << std::endl;
+        std::cerr << "USAGE: test <in> <out>..." << std::endl;
+        std::cerr << "       test <in> [--jit|--lazy-jit] <function> <arg>..." << std::endl;
         return 1;
     }
 
     const std::string input_filename = argv[1];
-    const std::string output_filename = argv[2];
     const auto module_id = std::filesystem::path(argv[1])
                            .replace_extension()
                            .filename()
@@ -92,14 +92,24 @@ int main(const int argc, const char** argv)
         return 1;
     }
 
-    Pipeline()
-        .ParseStmtFn("def", parse_def)
-        .ParseStmtFn("extern", parse_extern)
-        .ParseExprFn("if", parse_if)
+    Pipeline pipeline;
+    Test::Register(pipeline)
         .DumpAST(true)
         .DumpIR(true)
-        .ModuleID(module_id)
-        .BuildAndEmit(stream, input_filename, output_filename);
+        .ModuleID(module_id);
+
+    if (jit)
+    {
+        pipeline.LazyJIT(std::string(argv[2]) == "--lazy-jit");
+        std::vector<double> args;
+        for (int i = 4; i < argc; ++i)
+            args.push_back(std::stod(argv[i]));
+        return run_jit(pipeline, stream, input_filename, argv[3], args);
+    }
+
+    for (int i = 2; i < argc; ++i)
+        pipeline.Emit(get_output_kind(argv[i]), argv[i]);
+    pipeline.Build(stream, input_filename);
 
     return 0;
 }
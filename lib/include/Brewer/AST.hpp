@@ -17,6 +17,13 @@ namespace Brewer
         virtual std::ostream& Dump(std::ostream&) const = 0;
         virtual void GenIRNoVal(Builder&) const = 0;
 
+        // creates the declarations of everything the statement defines, without lowering any body.
+        // incremental builds call this before they load a previously generated body in its place
+        virtual void Declare(Builder&) const;
+        // the name of the function the statement defines, if any. lazy builds defer such statements until
+        // the function is first required
+        [[nodiscard]] virtual std::string GetDefinedName() const;
+
         SourceLocation Location;
     };
 
@@ -71,6 +78,9 @@ namespace Brewer
         ValuePtr GenIR(Builder&) const override;
 
         double Value;
+
+        // literals without a width suffix adopt the type of the operand they are combined with
+        bool Suffixed = false;
     };
 
     struct ConstIntExpression : Expression
@@ -81,6 +91,7 @@ namespace Brewer
         ValuePtr GenIR(Builder&) const override;
 
         unsigned long long Value;
+        bool Suffixed = false;
     };
 
     struct ConstStringExpression : Expression
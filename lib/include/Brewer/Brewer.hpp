@@ -46,4 +46,6 @@ namespace Brewer
     typedef std::function<ExprPtr(Parser&)> ExprFn;
     typedef std::function<ValuePtr(Builder&, const ValuePtr&, const ValuePtr&, TypePtr*)> BinaryFn;
     typedef std::function<ValuePtr(Builder&, const ValuePtr&, TypePtr*)> UnaryFn;
+    typedef std::function<ValuePtr(Builder&, const Expression&, const Expression&, TypePtr*)> LazyBinaryFn;
+    typedef std::function<void(Builder&, const Statement&)> DeferredFn;
 }
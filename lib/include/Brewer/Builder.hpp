@@ -1,16 +1,70 @@
 #pragma once
 
+#include <future>
 #include <map>
 #include <memory>
+#include <set>
 #include <string>
 #include <vector>
+#include <Brewer/AST.hpp>
 #include <Brewer/Brewer.hpp>
+#include <Brewer/Cache.hpp>
+#include <Brewer/Optimizer.hpp>
+#include <Brewer/Timing.hpp>
+#include <llvm/ExecutionEngine/Orc/ThreadSafeModule.h>
 #include <llvm/IR/IRBuilder.h>
+#include <llvm/IR/Intrinsics.h>
 #include <llvm/IR/LLVMContext.h>
 #include <llvm/IR/Module.h>
+#include <llvm/Support/raw_ostream.h>
+#include <llvm/Support/ThreadPool.h>
+#include <llvm/Target/TargetMachine.h>
 
 namespace Brewer
 {
+    enum OutputKind
+    {
+        OutputKind_Object,
+        OutputKind_Assembly,
+        OutputKind_Bitcode,
+        OutputKind_IR,
+    };
+
+    // what the predefined integer operators may assume about overflow. assuming more lets the optimizer
+    // widen induction variables and strength reduce, but overflowing is undefined then
+    enum OverflowMode
+    {
+        OverflowMode_Wrap,
+        // signed operations are nsw, unsigned ones still wrap
+        OverflowMode_NoSignedWrap,
+        // signed operations are nsw, unsigned ones nuw
+        OverflowMode_NoWrap,
+    };
+
+    enum TailCallMode
+    {
+        TailCallMode_None,
+        // calls in tail position are marked 'tail'
+        TailCallMode_Tail,
+        // and 'musttail' if the callee has the caller's signature. internal functions use fastcc
+        TailCallMode_MustTail,
+    };
+
+    struct Output
+    {
+        OutputKind Kind;
+        std::string Filename;
+    };
+
+    struct IntrinsicMapping
+    {
+        FunctionTypePtr Type;
+        llvm::Intrinsic::ID ID;
+        // constant arguments the intrinsic takes after the ones of the signature, like the volatile flag
+        // of memcpy. they are appended at each call site
+        std::vector<llvm::Constant*> Extra;
+    };
+
     class Builder
     {
     public:
@@ -21,8 +75,6 @@ namespace Brewer
         static ValuePtr GenGT(Builder&, const ValuePtr& lhs, const ValuePtr& rhs, TypePtr*);
         static ValuePtr GenLE(Builder&, const ValuePtr& lhs, const ValuePtr& rhs, TypePtr*);
         static ValuePtr GenGE(Builder&, const ValuePtr& lhs, const ValuePtr& rhs, TypePtr*);
-        static ValuePtr GenLAnd(Builder&, const ValuePtr& lhs, const ValuePtr& rhs, TypePtr*);
-        static ValuePtr GenLOr(Builder&, const ValuePtr& lhs, const ValuePtr& rhs, TypePtr*);
         static ValuePtr GenLXor(Builder&, const ValuePtr& lhs, const ValuePtr& rhs, TypePtr*);
         static ValuePtr GenAdd(Builder&, const ValuePtr& lhs, const ValuePtr& rhs, TypePtr*);
         static ValuePtr GenSub(Builder&, const ValuePtr& lhs, const ValuePtr& rhs, TypePtr*);
@@ -36,6 +88,10 @@ namespace Brewer
         static ValuePtr GenLShr(Builder&, const ValuePtr& lhs, const ValuePtr& rhs, TypePtr*);
         static ValuePtr GenAShr(Builder&, const ValuePtr& lhs, const ValuePtr& rhs, TypePtr*);
 
+        // predefined lazy binary operators
+        static ValuePtr GenLAnd(Builder&, const Expression& lhs, const Expression& rhs, TypePtr*);
+        static ValuePtr GenLOr(Builder&, const Expression& lhs, const Expression& rhs, TypePtr*);
+
         // predefined unary operators
         static ValuePtr GenInc(Builder&, const ValuePtr&, TypePtr*);
         static ValuePtr GenDec(Builder&, const ValuePtr&, TypePtr*);
@@ -49,18 +105,143 @@ namespace Brewer
         [[nodiscard]] llvm::Function* GetGlobalDtor() const;
         void CloseGlobals() const;
 
+        void SetOptLevel(unsigned level);
+        void SetStreaming(bool);
+
+        // mergeable strings are linkonce_odr and named after their contents, so the linker keeps a single
+        // copy of every string across all modules
+        void SetMergeableStrings(bool);
+
+        // the fast-math flags of every floating point operation, llvm::FastMathFlags::getFast() being the
+        // 'fast' preset. a front end can override them for single functions, e.g. from a custom statement
+        void SetFastMathFlags(llvm::FastMathFlags);
+        void SetFunctionFastMathFlags(llvm::Function*, llvm::FastMathFlags);
+        // fast contraction also marks every operation 'contract', so the optimizer may form fma as well
+        void SetFPContract(llvm::FPOpFusion::FPOpFusionMode);
+
+        void SetTailCalls(TailCallMode);
+        void SetOverflow(OverflowMode);
+        // if add, sub, mul and shl of the given integer type may be marked nsw or nuw
+        [[nodiscard]] bool HasNSW(const TypePtr&) const;
+        [[nodiscard]] bool HasNUW(const TypePtr&) const;
+
+        // sets the fast-math flags of the ir builder to those of the function at the insert point.
+        // the expressions call this before every operator, so custom operators get the flags too. callers
+        // scope it with an llvm::IRBuilderBase::FastMathFlagGuard, so the flags do not leak into later code
+        void SelectFastMathFlags();
+
+        void SetTiming(Timing*);
+        [[nodiscard]] Timing* GetTiming() const;
+
+        // front ends call this as soon as a function body is complete. in streaming mode a copy of the
+        // function is simplified on a worker with a context of its own while the parser moves on, and the
+        // result replaces the body before the module is optimized, internalized, emitted or taken
+        void CloseFunction(llvm::Function*);
+        // waits for the functions still being optimized and loads their results
+        void JoinStreamed();
+        // how many streamed functions kept their unoptimized body, because the worker failed or its result
+        // did not fit into the module. they are simplified with the rest of the module instead
+        [[nodiscard]] size_t GetStreamingFallbacks() const;
+        // marks the calls whose result the function returns directly. returns of a phi, like the one
+        // an if expression ends with, are duplicated into the arms first, so calls in either arm count
+        void MarkTailCalls(llvm::Function*) const;
+        // adds the attributes the body proves, e.g. nounwind, willreturn, norecurse, nofree, the memory
+        // effects and nocapture/readonly on pointer parameters. attributes that are already set are kept
+        static void InferAttributes(llvm::Function*);
+        void Optimize();
+
+        // a module with exports, given to the pipeline or marked by the front end, hides everything else.
+        // Internalize gives every other function definition internal linkage and removes the unreferenced
+        // ones, so it must only run once the module is complete. internal functions then use fastcc
+        void Export(const std::string& name);
+        [[nodiscard]] bool IsExported(const std::string& name) const;
+        void Internalize();
+
+        // a deferred definition is declared right away, but its body is only generated once the function is
+        // required, i.e. referenced by a symbol expression or exported. CloseDeferred generates the exported
+        // definitions, or all of them if there are no exports, and discards the rest. a body is generated by
+        // the given function if there is one, e.g. to take it from a fragment, or by GenIRNoVal otherwise
+        void Defer(const std::string& name, StmtPtr statement, DeferredFn generate = {});
+        void Require(const std::string& name);
+        void CloseDeferred();
+
+        // while recording, every function passed to CloseFunction is remembered until it is taken
+        void RecordClosedFunctions(bool);
+        std::vector<llvm::Function*> TakeClosedFunctions();
+
+        // a fragment is a bitcode module with the bodies of the given functions and declarations of
+        // everything they refer to. loading it moves the bodies into the declared functions of this module,
+        // and fails without changing anything if any of the declarations does not match
+        [[nodiscard]] std::string SaveFragment(llvm::ArrayRef<llvm::Function*> functions) const;
+        bool LoadFragment(llvm::StringRef fragment);
+
         [[nodiscard]] Context& GetContext() const;
         [[nodiscard]] llvm::LLVMContext& IRContext() const;
         [[nodiscard]] llvm::IRBuilder<>& IRBuilder() const;
         [[nodiscard]] llvm::Module& IRModule() const;
 
+        llvm::orc::ThreadSafeModule TakeModule();
+
         BinaryFn& GenBinaryFn(const std::string& operator_);
         UnaryFn& GenUnaryFn(const std::string& operator_);
 
+        // a lazy operator receives its operands unevaluated and decides itself if and when to generate them,
+        // e.g. to short circuit. it shadows an eager one registered for the same operator at the same or a
+        // lower level, and the other way around
+        LazyBinaryFn& GenLazyBinaryFn(const std::string& operator_);
+
+        // operators are looked up locally first, then in the shared registrations and then in the predefined
+        // ones. the shared maps are only ever read, so one set can serve any number of builders at once
+        void Inherit(const std::map<std::string, BinaryFn>& binary_fns,
+                     const std::map<std::string, UnaryFn>& unary_fns,
+                     const std::map<std::string, LazyBinaryFn>& lazy_binary_fns);
+
+        [[nodiscard]] const BinaryFn& GetBinaryFn(const std::string& operator_) const;
+        [[nodiscard]] const UnaryFn& GetUnaryFn(const std::string& operator_) const;
+        [[nodiscard]] const LazyBinaryFn& GetLazyBinaryFn(const std::string& operator_) const;
+
+        // true if the operator resolves to the predefined handler, i.e. no registration overrides it
+        [[nodiscard]] bool IsPredefinedBinaryFn(const std::string& operator_) const;
+        [[nodiscard]] bool IsPredefinedUnaryFn(const std::string& operator_) const;
+
+        // prints the module to Out()
         void Dump() const;
-        void EmitToFile(const std::string& filename) const;
+        bool EmitToFile(const std::string& filename, OutputKind kind = OutputKind_Object);
+        // machine code outputs are split into max(threads, partitions) files if that is more than one
+        bool EmitToFiles(const std::vector<Output>& outputs, unsigned threads = 1, unsigned partitions = 0);
+        bool EmitToFilesParallel(const std::string& filename, OutputKind kind, unsigned threads, unsigned partitions = 0);
+        bool EmitToBuffer(llvm::SmallVectorImpl<char>& buffer, OutputKind kind = OutputKind_Object);
+        bool Emit(llvm::raw_pwrite_stream& stream, OutputKind kind);
+
+        // splits the module into one partition per stream and generates their code on up to 'threads' workers.
+        // the split only depends on the module and the number of streams, and every partition always goes to the
+        // stream with its index, so the output is the same no matter how the workers are scheduled
+        bool EmitParallel(llvm::ArrayRef<llvm::raw_pwrite_stream*> streams, OutputKind kind, unsigned threads);
 
+        // with a partition cache, the code of every partition is looked up by its bitcode before it is generated,
+        // and stored afterward. the split and the names of the locals only depend on the functions, so code
+        // for partitions whose functions did not change is reused, e.g. across incremental builds
+        void SetPartitionCache(std::shared_ptr<Cache>);
+
+        // 'out/file.o' becomes 'out/file.<partition>.o'
+        static std::string GetPartitionFilename(const std::string& filename, unsigned partition);
+
+        // triple, cpu and features of the machine code the builders generate
+        static const std::string& GetTargetKey();
+
+        // free functions nobody declared fall back to the intrinsic registry, so a call to e.g. 'sqrt' becomes
+        // a direct call to llvm.sqrt.f64 without any declaration. a declaration under the same name wins
         ValuePtr& GetFunction(const TypePtr&, const std::string&);
+
+        // besides the predefined mappings, i.e. sqrt, fabs, floor, fma, copysign, fmin and fmax (with an 'f'
+        // suffix for f32), ctpop, ctlz and bswap (with a 16 or 32 suffix for narrower types), memcpy, memset,
+        // prefetch and expect
+        void GenIntrinsic(const std::string& name, const IntrinsicMapping& mapping);
+        // the function for the intrinsic registered under the name, if there is one and its signature
+        // matches the given type
+        ValuePtr GetIntrinsic(const std::string& name, const FunctionTypePtr& type = {});
+        // the extra constant arguments of a function returned by GetIntrinsic, empty for anything else
+        llvm::ArrayRef<llvm::Constant*> GetIntrinsicExtra(const ValuePtr& callee) const;
         ValuePtr GetCtor(const TypePtr&);
 
         ValuePtr& GetSymbol(const std::string& name);
@@ -72,17 +253,68 @@ namespace Brewer
 
         ValuePtr GenCast(const ValuePtr& src, const TypePtr& dst);
 
+        // string literals are pooled, so every distinct string is emitted once as an unnamed_addr constant
+        llvm::Constant* GetString(const std::string& value);
+
     private:
+        static std::unique_ptr<llvm::TargetMachine> CreateTargetMachine();
+
+        llvm::TargetMachine* GetTargetMachine();
+
+        void StreamFunction(llvm::Function*);
+
         Context& m_Context;
 
         std::unique_ptr<llvm::LLVMContext> m_IRContext;
         std::unique_ptr<llvm::IRBuilder<>> m_IRBuilder;
         std::unique_ptr<llvm::Module> m_IRModule;
+        std::unique_ptr<llvm::TargetMachine> m_TargetMachine;
+        std::unique_ptr<Optimizer> m_Optimizer;
+        std::shared_ptr<Cache> m_PartitionCache;
+
+        // the state of the streaming worker is only ever touched by the worker itself. the pool comes last,
+        // so it is stopped before anything it uses goes away
+        std::unique_ptr<llvm::TargetMachine> m_StreamMachine;
+        std::unique_ptr<Optimizer> m_StreamOptimizer;
+        std::vector<std::pair<llvm::Function*, std::shared_future<std::string>>> m_Streamed;
+        std::set<llvm::Function*> m_StreamedFunctions;
+        size_t m_StreamingFallbacks = 0;
+        std::unique_ptr<llvm::ThreadPool> m_StreamPool;
+
+        unsigned m_OptLevel = 0;
+        bool m_Streaming = false;
+        bool m_MergeableStrings = false;
+
+        llvm::FastMathFlags m_FastMathFlags;
+        std::map<llvm::Function*, llvm::FastMathFlags> m_FunctionFastMathFlags;
+        llvm::FPOpFusion::FPOpFusionMode m_FPContract = llvm::FPOpFusion::Standard;
+
+        OverflowMode m_Overflow = OverflowMode_Wrap;
+        TailCallMode m_TailCalls = TailCallMode_None;
+
+        Timing* m_Timing = nullptr;
+
+        bool m_RecordClosed = false;
+        std::vector<llvm::Function*> m_ClosedFunctions;
 
         llvm::Function *m_GlobalCtor, *m_GlobalDtor;
 
         std::map<std::string, BinaryFn> m_BinaryFns;
         std::map<std::string, UnaryFn> m_UnaryFns;
+        std::map<std::string, LazyBinaryFn> m_LazyBinaryFns;
+
+        const std::map<std::string, BinaryFn>* m_SharedBinaryFns = nullptr;
+        const std::map<std::string, UnaryFn>* m_SharedUnaryFns = nullptr;
+        const std::map<std::string, LazyBinaryFn>* m_SharedLazyBinaryFns = nullptr;
+
+        std::map<std::string, llvm::GlobalVariable*> m_Strings;
+
+        std::set<std::string> m_Exports;
+        std::map<std::string, std::pair<StmtPtr, DeferredFn>> m_Deferred;
+
+        bool m_IntrinsicsRegistered = false;
+        std::map<std::string, IntrinsicMapping> m_Intrinsics;
+        std::map<std::string, ValuePtr> m_IntrinsicFunctions;
 
         std::map<TypePtr, std::map<std::string, ValuePtr>> m_Functions;
         std::vector<std::map<std::string, ValuePtr>> m_Stack;
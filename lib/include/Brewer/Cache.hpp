@@ -0,0 +1,40 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <llvm/ADT/StringRef.h>
+#include <llvm/Support/MemoryBuffer.h>
+
+namespace Brewer
+{
+    class Cache
+    {
+    public:
+        static std::string Hash(llvm::ArrayRef<llvm::StringRef> parts);
+
+        // max_size is the size bound of the directory in bytes, 0 means unbounded
+        explicit Cache(std::string directory, uint64_t max_size = 0);
+
+        [[nodiscard]] const std::string& GetDirectory() const;
+        [[nodiscard]] size_t GetHits() const;
+        [[nodiscard]] size_t GetMisses() const;
+
+        std::unique_ptr<llvm::MemoryBuffer> Get(const std::string& key);
+        void Put(const std::string& key, llvm::StringRef data);
+        void Prune();
+
+    private:
+        std::string m_Directory;
+        uint64_t m_MaxSize;
+
+        std::mutex m_Mutex;
+        uint64_t m_Size = 0;
+        bool m_SizeKnown = false;
+
+        std::atomic<size_t> m_Hits = 0;
+        std::atomic<size_t> m_Misses = 0;
+    };
+}
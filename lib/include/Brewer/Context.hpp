@@ -12,6 +12,7 @@ namespace Brewer
         Context();
 
         TypePtr& GetType(const std::string& name);
+        [[nodiscard]] size_t GetTypeCount() const;
 
         TypePtr GetVoidTy();
         TypePtr GetIntNTy(size_t);
@@ -20,6 +21,7 @@ namespace Brewer
         TypePtr GetInt16Ty();
         TypePtr GetInt32Ty();
         TypePtr GetInt64Ty();
+        TypePtr GetUIntNTy(size_t);
         TypePtr GetFloatNTy(size_t);
         TypePtr GetFloat16Ty();
         TypePtr GetFloat32Ty();
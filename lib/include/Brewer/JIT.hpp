@@ -0,0 +1,58 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <Brewer/Brewer.hpp>
+#include <Brewer/Cache.hpp>
+#include <Brewer/ObjectCache.hpp>
+#include <llvm/ExecutionEngine/Orc/LLJIT.h>
+#include <llvm/Target/TargetOptions.h>
+
+namespace Brewer
+{
+    struct JITStatistics
+    {
+        // number of modules (or lazy partitions) handed to the compiler
+        size_t Modules;
+        // number of function definitions actually compiled
+        size_t Functions;
+    };
+
+    class JIT
+    {
+    public:
+        // fp_contract has to match the one the module was built with, see Builder::SetFPContract
+        static std::unique_ptr<JIT> Create(bool lazy = false,
+                                           const std::shared_ptr<Cache>& cache = {},
+                                           llvm::FPOpFusion::FPOpFusionMode fp_contract = llvm::FPOpFusion::Standard);
+
+        JIT(std::unique_ptr<llvm::orc::LLJIT> jit, bool lazy, std::unique_ptr<ObjectCache> object_cache = {});
+        ~JIT();
+
+        [[nodiscard]] llvm::orc::LLJIT& GetLLJIT() const;
+        [[nodiscard]] bool IsLazy() const;
+        [[nodiscard]] JITStatistics GetStatistics() const;
+        [[nodiscard]] ObjectCache* GetObjectCache() const;
+
+        bool Add(Builder&);
+        bool Initialize();
+
+        void* Lookup(const std::string& name) const;
+
+        template <typename T>
+        T* Lookup(const std::string& name) const
+        {
+            return reinterpret_cast<T*>(Lookup(name));
+        }
+
+    private:
+        std::unique_ptr<ObjectCache> m_ObjectCache;
+        std::unique_ptr<llvm::orc::LLJIT> m_JIT;
+        bool m_Lazy;
+        bool m_Initialized = false;
+
+        std::atomic<size_t> m_CompiledModules = 0;
+        std::atomic<size_t> m_CompiledFunctions = 0;
+    };
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <iostream>
+#include <Brewer/Timing.hpp>
+
+namespace Brewer
+{
+    struct AllocationCount
+    {
+        uint64_t Count;
+        uint64_t Bytes;
+    };
+
+    // one entry per phase, the last one holds everything allocated outside of any phase
+    typedef std::array<AllocationCount, Phase_Count + 1> PhaseAllocations;
+
+    // allocations are only counted if brewer was built with BREWER_COUNT_ALLOCATIONS, which replaces the
+    // global operator new of the whole program
+    bool IsCountingAllocations();
+    void CountAllocation(size_t bytes);
+    PhaseAllocations GetThreadAllocations();
+
+    // in bytes, for the whole process
+    size_t GetPeakRSS();
+
+    struct MemoryStatistics
+    {
+        void Merge(const MemoryStatistics&);
+        void DumpJSON(std::ostream&) const;
+
+        size_t Builds = 0;
+        size_t PeakRSS = 0;
+        PhaseAllocations Allocations{};
+
+        // summed over all builds
+        size_t Types = 0;
+        size_t Functions = 0;
+        size_t BasicBlocks = 0;
+        size_t Instructions = 0;
+    };
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <Brewer/Cache.hpp>
+#include <llvm/ExecutionEngine/ObjectCache.h>
+
+namespace Brewer
+{
+    class ObjectCache : public llvm::ObjectCache
+    {
+    public:
+        explicit ObjectCache(std::shared_ptr<Cache> cache);
+
+        [[nodiscard]] Cache& GetCache() const;
+
+        // target triple, cpu, features, optimization level and fp contraction, everything besides the module that
+        // changes the object
+        void SetTarget(const std::string& target);
+
+        void notifyObjectCompiled(const llvm::Module*, llvm::MemoryBufferRef object) override;
+        std::unique_ptr<llvm::MemoryBuffer> getObject(const llvm::Module*) override;
+
+    private:
+        std::shared_ptr<Cache> m_Cache;
+        std::string m_Target;
+
+        std::mutex m_Mutex;
+        std::map<const llvm::Module*, std::string> m_Keys;
+    };
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <llvm/IR/Function.h>
+#include <llvm/IR/Module.h>
+#include <llvm/IR/PassManager.h>
+#include <llvm/Passes/PassBuilder.h>
+#include <llvm/Passes/StandardInstrumentations.h>
+#include <llvm/Target/TargetMachine.h>
+
+namespace Brewer
+{
+    class Optimizer
+    {
+    public:
+        // level is 0 to 3, like -O0 to -O3
+        Optimizer(unsigned level, llvm::TargetMachine* machine);
+
+        [[nodiscard]] unsigned GetLevel() const;
+
+        // function simplification only, for functions that are done while the rest of the module is not
+        void Run(llvm::Function&);
+        // the full per module pipeline
+        void Run(llvm::Module&);
+        // the rest of the per module pipeline for a module whose functions all went through Run(Function&)
+        // already: inlining, simplifying only the functions that may have been inlined into once more, and
+        // the module optimizations
+        void RunSimplified(llvm::Module&);
+
+    private:
+        unsigned m_Level;
+
+        llvm::PassInstrumentationCallbacks m_PIC;
+        llvm::TimeProfilingPassesHandler m_TimeProfiling;
+
+        llvm::LoopAnalysisManager m_LAM;
+        llvm::FunctionAnalysisManager m_FAM;
+        llvm::CGSCCAnalysisManager m_CGAM;
+        llvm::ModuleAnalysisManager m_MAM;
+        llvm::PassBuilder m_PassBuilder;
+
+        llvm::FunctionPassManager m_FPM;
+    };
+}
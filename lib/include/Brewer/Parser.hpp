@@ -21,9 +21,19 @@ namespace Brewer
         StmtFn& ParseStmtFn(const std::string&);
         ExprFn& ParseExprFn(const std::string&);
 
+        // local registrations take precedence over the shared ones, which are only ever read
+        void Inherit(const std::map<std::string, StmtFn>& stmt_fns, const std::map<std::string, ExprFn>& expr_fns);
+
+        [[nodiscard]] const StmtFn& GetStmtFn(const std::string&) const;
+        [[nodiscard]] const ExprFn& GetExprFn(const std::string&) const;
+
         Token& Next();
         Token& Current();
 
+        // collects the type and value of every token consumed until EndFingerprint
+        void BeginFingerprint();
+        std::string EndFingerprint();
+
         [[nodiscard]] bool At(TokenType) const;
         [[nodiscard]] bool At(const std::string&) const;
         [[nodiscard]] bool AtEOF() const;
@@ -39,6 +49,11 @@ namespace Brewer
         ExprPtr ParseExpr();
         TypePtr ParseType();
 
+        // replaces an operator node whose operands are all literals by the literal it evaluates to, as long as
+        // the operator is not overridden. the parser folds every operator node it creates, so constant
+        // sub-trees collapse bottom up before any ir is generated
+        ExprPtr Fold(ExprPtr);
+
     private:
         int Get();
         void NewLine();
@@ -65,7 +80,13 @@ namespace Brewer
 
         Token m_Token;
 
+        bool m_Fingerprinting = false;
+        std::string m_Fingerprint;
+
         std::map<std::string, StmtFn> m_StmtFnMap;
         std::map<std::string, ExprFn> m_ExprFnMap;
+
+        const std::map<std::string, StmtFn>* m_SharedStmtFnMap = nullptr;
+        const std::map<std::string, ExprFn>* m_SharedExprFnMap = nullptr;
     };
 }
@@ -1,11 +1,46 @@
 #pragma once
 
+#include <atomic>
+#include <functional>
 #include <map>
+#include <memory>
+#include <mutex>
+#include <set>
 #include <string>
+#include <vector>
 #include <Brewer/Brewer.hpp>
+#include <Brewer/Builder.hpp>
+#include <Brewer/Cache.hpp>
+#include <Brewer/JIT.hpp>
+#include <Brewer/Memory.hpp>
+#include <Brewer/Timing.hpp>
+#include <llvm/Support/MemoryBuffer.h>
 
 namespace Brewer
 {
+    struct BuildInput
+    {
+        std::string Filename;
+        std::vector<Output> Outputs;
+    };
+
+    struct BuildResult
+    {
+        std::string Filename;
+        bool Success = false;
+        std::string Diagnostics;
+        // the dumps and the time report of the build, see Out()
+        std::string Output;
+    };
+
+    struct CompileCacheStatistics
+    {
+        size_t Hits;
+        size_t Misses;
+        size_t FragmentHits;
+        size_t FragmentMisses;
+    };
+
     class Pipeline
     {
     public:
@@ -15,24 +50,142 @@ namespace Brewer
         Pipeline& ParseExprFn(const std::string& beg, const ExprFn& fn);
         Pipeline& GenBinaryFn(const std::string& operator_, const BinaryFn& fn);
         Pipeline& GenUnaryFn(const std::string& operator_, const UnaryFn& fn);
+        Pipeline& GenLazyBinaryFn(const std::string& operator_, const LazyBinaryFn& fn);
         Pipeline& ModuleID(const std::string& module_id);
         Pipeline& DumpAST(bool);
         Pipeline& DumpIR(bool);
+        Pipeline& Optimize(unsigned level);
+        Pipeline& Streaming(bool);
+        // see Builder::SetMergeableStrings
+        Pipeline& MergeableStrings(bool);
+        // see Builder::SetFastMathFlags and Builder::SetFPContract
+        Pipeline& FastMath(llvm::FastMathFlags);
+        Pipeline& FPContract(llvm::FPOpFusion::FPOpFusionMode);
+        Pipeline& Overflow(OverflowMode);
+        Pipeline& TailCalls(TailCallMode);
+        // see Builder::Export. the exports apply to every module the pipeline builds
+        Pipeline& Export(const std::string& name);
+        // defers every statement that defines a function, see Builder::Defer, so only the bodies reachable
+        // from the exports and the top level code are generated. the others are dropped with their ast. with
+        // Incremental, the bodies that are generated still come from their fragments
+        Pipeline& Lazy(bool);
+        Pipeline& Emit(OutputKind kind, const std::string& filename);
+        Pipeline& Threads(unsigned);
+        Pipeline& LazyJIT(bool);
+        Pipeline& JITCache(const std::string& directory, uint64_t max_size = 0);
+
+        // caches the emitted files by the hash of the source, the configuration, the target and the brewer
+        // version. the registered functions cannot be hashed, so their names are part of the key, and the
+        // config version has to be changed whenever their behavior changes. a hit skips the build entirely, so
+        // the ast and ir dumps and the time report are only printed for misses
+        Pipeline& CompileCache(const std::string& directory, uint64_t max_size = 0);
+        Pipeline& ConfigVersion(const std::string& version);
+
+        // fingerprints every top level statement by its tokens and reuses the ir it generated last time,
+        // as long as every declaration it refers to still has the same type. the fragments are kept in
+        // memory, and in the compile cache if there is one
+        Pipeline& Incremental(bool);
+        // with a compile cache, the machine code outputs of incremental builds are split into this many
+        // partitions, named like those of parallel builds, and the code of every partition whose ir did not
+        // change is taken from the cache. an edit then only regenerates the partitions of the changed functions
+        Pipeline& IncrementalPartitions(unsigned);
+
+        // prints the time spent in each phase and the slowest statements and functions after every build
+        Pipeline& TimeReport(bool);
+        // writes a chrome trace event file of every build. events shorter than the granularity are dropped
+        Pipeline& TimeTrace(const std::string& filename, unsigned granularity_us = 500);
+
+        // the timing of all builds so far, if the time report is enabled
+        [[nodiscard]] Timing GetTiming();
+
+        // collects peak rss, allocations per phase, type table sizes and module sizes of every build
+        Pipeline& MemoryStats(bool);
+        [[nodiscard]] MemoryStatistics GetMemoryStatistics();
+
+        [[nodiscard]] CompileCacheStatistics GetCompileCacheStatistics() const;
+        // see Builder::GetStreamingFallbacks, summed over all builds so far
+        [[nodiscard]] size_t GetStreamingFallbacks() const;
 
         void Build(std::istream& stream, const std::string& input_filename);
         void BuildAndEmit(std::istream& stream, const std::string& input_filename, const std::string& output_filename);
+        std::unique_ptr<llvm::MemoryBuffer> BuildToBuffer(std::istream& stream,
+                                                          const std::string& input_filename,
+                                                          OutputKind kind = OutputKind_Object);
+        std::unique_ptr<JIT> BuildAndJIT(std::istream& stream, const std::string& input_filename);
+
+        // compiles every input on its own worker, up to 'Threads' at a time. all builds read the same
+        // registrations, so none of them may be changed until this returns. the diagnostics and the output
+        // of each input are collected into its result instead of being written to std::cerr
+        std::vector<BuildResult> BuildMany(const std::vector<BuildInput>& inputs);
 
     private:
-        std::string m_OutputFilename;
+        void Build(std::istream& stream,
+                   const std::string& input_filename,
+                   const std::function<void(Builder&)>& emit,
+                   bool report = true);
+        void BuildModule(std::istream& stream,
+                         const std::string& input_filename,
+                         const std::function<void(Builder&)>& emit,
+                         Timing* timing,
+                         MemoryStatistics* memory);
+        void GenIRIncremental(Builder& builder, const Statement& statement, const std::string& key);
+        std::string FindFragment(const std::string& key);
+        void StoreFragment(const std::string& key, std::string fragment);
+
+        bool BuildToFiles(std::istream& stream,
+                          const std::string& input_filename,
+                          const std::vector<Output>& outputs,
+                          unsigned threads,
+                          bool report = true);
+
+        [[nodiscard]] std::string GetCompileCacheKey(llvm::StringRef source,
+                                                     const std::string& input_filename,
+                                                     unsigned threads) const;
+
         std::string m_ModuleID;
+        std::vector<Output> m_Outputs;
+        std::shared_ptr<Cache> m_JITCache;
+        std::shared_ptr<Cache> m_CompileCache;
+        std::string m_ConfigVersion;
 
         std::map<std::string, StmtFn> m_StmtFns;
         std::map<std::string, ExprFn> m_ExprFns;
         std::map<std::string, BinaryFn> m_BinaryFns;
         std::map<std::string, UnaryFn> m_UnaryFns;
+        std::map<std::string, LazyBinaryFn> m_LazyBinaryFns;
 
         bool m_DumpAST = false;
         bool m_DumpIR = false;
-        bool m_EmitToFile = false;
+        unsigned m_OptLevel = 0;
+        bool m_Streaming = false;
+        bool m_MergeableStrings = false;
+        llvm::FastMathFlags m_FastMathFlags;
+        llvm::FPOpFusion::FPOpFusionMode m_FPContract = llvm::FPOpFusion::Standard;
+        OverflowMode m_Overflow = OverflowMode_Wrap;
+        TailCallMode m_TailCalls = TailCallMode_None;
+        std::set<std::string> m_Exports;
+        bool m_Lazy = false;
+        bool m_LazyJIT = false;
+        unsigned m_Threads = 1;
+        bool m_Incremental = false;
+        unsigned m_IncrementalPartitions = 0;
+        bool m_TimeReport = false;
+        std::string m_TimeTraceFilename;
+        unsigned m_TimeTraceGranularity = 500;
+
+        bool m_MemoryStats = false;
+
+        std::mutex m_StatisticsMutex;
+        Timing m_Timing;
+        MemoryStatistics m_MemoryStatistics;
+
+        std::mutex m_FragmentMutex;
+        std::map<std::string, std::string> m_Fragments;
+
+        std::atomic<size_t> m_CompileCacheHits = 0;
+        std::atomic<size_t> m_CompileCacheMisses = 0;
+        std::atomic<size_t> m_FragmentHits = 0;
+        std::atomic<size_t> m_FragmentMisses = 0;
+        std::atomic<size_t> m_StreamingFallbacks = 0;
     };
 }
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+#include <llvm/ADT/STLFunctionalExtras.h>
+
+namespace Brewer
+{
+    enum Phase
+    {
+        Phase_Lex,
+        Phase_Parse,
+        Phase_IRGen,
+        Phase_Optimize,
+        Phase_Codegen,
+        Phase_Count,
+    };
+
+    class Timing
+    {
+    public:
+        typedef std::chrono::steady_clock Clock;
+
+        static const char* GetPhaseName(Phase);
+
+        void Add(Phase, Clock::duration);
+        // items are single statements or functions, the summary lists the slowest ones
+        void AddItem(std::string name, Clock::duration);
+        void Merge(const Timing&);
+
+        [[nodiscard]] Clock::duration Get(Phase) const;
+        [[nodiscard]] Clock::duration GetTotal() const;
+
+        void Print(std::ostream&, size_t items = 10) const;
+
+    private:
+        Clock::duration m_Phases[Phase_Count]{};
+        std::vector<std::pair<std::string, Clock::duration>> m_Items;
+    };
+
+    // measures the time until it goes out of scope, without the time spent in nested scopes of other
+    // phases, so that the phases of a timing add up to its total. without a timing it only marks the
+    // current phase of the thread
+    class PhaseScope
+    {
+    public:
+        // the phase of the innermost scope on the calling thread, or Phase_Count outside of any
+        static Phase GetCurrentPhase();
+
+        PhaseScope(Timing*, Phase, llvm::function_ref<std::string()> item = {});
+        ~PhaseScope();
+
+        PhaseScope(const PhaseScope&) = delete;
+        PhaseScope& operator=(const PhaseScope&) = delete;
+
+    private:
+        Timing* m_Timing;
+        Phase m_Phase;
+        std::string m_Item;
+
+        PhaseScope* m_Parent = nullptr;
+        Timing::Clock::time_point m_Start;
+    };
+}
@@ -40,7 +40,7 @@ namespace Brewer
 
         static TypePtr GetHigherOrder(const TypePtr&, const TypePtr&);
 
-        Type(Context&, std::string name, TypeID id, size_t size);
+        Type(Context&, std::string name, TypeID id, size_t size, bool is_signed = true);
         virtual ~Type();
 
         virtual llvm::Type* GenIR(Builder&) const;
@@ -59,6 +59,10 @@ namespace Brewer
         [[nodiscard]] bool IsInt32() const;
         [[nodiscard]] bool IsInt64() const;
 
+        // integers are signed unless declared otherwise, like the u8 to u64 types
+        [[nodiscard]] bool IsSigned() const;
+        [[nodiscard]] bool IsUnsigned() const;
+
         [[nodiscard]] bool IsFloat(size_t size = 0) const;
         [[nodiscard]] bool IsFloat16() const;
         [[nodiscard]] bool IsFloat32() const;
@@ -76,6 +80,7 @@ namespace Brewer
         std::string m_Name;
         TypeID m_ID;
         size_t m_Size;
+        bool m_Signed;
     };
 
     class PointerType : public Type
@@ -1,10 +1,37 @@
 #pragma once
 
 #include <iostream>
+#include <memory>
 #include <vector>
 
 namespace Brewer
 {
+    // the stream diagnostics are written to. it is per thread, so builds running side by side can each
+    // collect their own messages
+    inline std::ostream*& ErrStream()
+    {
+        thread_local std::ostream* stream = &std::cerr;
+        return stream;
+    }
+
+    inline std::ostream& Err()
+    {
+        return *ErrStream();
+    }
+
+    // the stream dumps and reports are written to, e.g. the ast, the ir and the time report. it is per thread
+    // like ErrStream, but kept apart from it, so the output asked for never counts as a diagnostic
+    inline std::ostream*& OutStream()
+    {
+        thread_local std::ostream* stream = &std::cerr;
+        return stream;
+    }
+
+    inline std::ostream& Out()
+    {
+        return *OutStream();
+    }
+
     template <typename T>
     struct ErrMark
     {
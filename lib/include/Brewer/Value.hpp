@@ -1,7 +1,9 @@
 #pragma once
 
 #include <Brewer/Brewer.hpp>
+#include <llvm/IR/Attributes.h>
 #include <llvm/IR/Value.h>
+#include <llvm/Support/ModRef.h>
 
 namespace Brewer
 {
@@ -20,6 +22,12 @@ namespace Brewer
 
         [[nodiscard]] virtual llvm::Value* Get() const;
 
+        // attribute hints for function values. they are kept when the attributes are inferred after the body
+        // is generated, so a front end may state what the inference cannot prove
+        bool AddFnAttr(llvm::Attribute::AttrKind) const;
+        bool AddParamAttr(unsigned index, llvm::Attribute::AttrKind) const;
+        bool SetMemoryEffects(llvm::MemoryEffects) const;
+
     private:
         Builder* m_Builder;
         TypePtr m_Type;
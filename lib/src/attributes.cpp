@@ -0,0 +1,179 @@
+#include <set>
+#include <Brewer/Builder.hpp>
+#include <llvm/Analysis/CFG.h>
+#include <llvm/Analysis/ValueTracking.h>
+#include <llvm/IR/Instructions.h>
+#include <llvm/IR/IntrinsicInst.h>
+
+enum Access
+{
+    Access_Local,
+    Access_Arg,
+    Access_Other,
+};
+
+// allocas of the function itself are not visible to its callers, so accessing them is no memory effect
+static Access get_access(const llvm::Value* ptr)
+{
+    const auto object = llvm::getUnderlyingObject(ptr);
+    if (llvm::isa<llvm::AllocaInst>(object)) return Access_Local;
+    if (llvm::isa<llvm::Argument>(object)) return Access_Arg;
+    return Access_Other;
+}
+
+static llvm::MemoryEffects get_effects(const Access access, const llvm::ModRefInfo info)
+{
+    switch (access)
+    {
+    case Access_Local:
+        return llvm::MemoryEffects::none();
+    case Access_Arg:
+        return llvm::MemoryEffects::argMemOnly(info);
+    default:
+        return llvm::MemoryEffects(info);
+    }
+}
+
+// the argument memory a call accesses is wherever its pointer arguments point to
+static llvm::MemoryEffects get_call_effects(const llvm::CallBase* call)
+{
+    const auto effects = call->getMemoryEffects();
+    const auto arg_info = effects.getModRef(llvm::IRMemLocation::ArgMem);
+
+    auto result = effects.getWithoutLoc(llvm::IRMemLocation::ArgMem);
+    if (arg_info == llvm::ModRefInfo::NoModRef) return result;
+
+    for (const auto& arg : call->args())
+        if (arg->getType()->isPointerTy())
+            result |= get_effects(get_access(arg), arg_info);
+    return result;
+}
+
+static bool does_not_recurse(const llvm::Function* callee)
+{
+    return callee
+           && (callee->doesNotRecurse()
+               || callee->isIntrinsic()
+               || callee->hasFnAttribute(llvm::Attribute::NoCallback));
+}
+
+// follows the uses of a pointer parameter through address computations
+static void infer_param(llvm::Argument* arg)
+{
+    auto captured = false, reads = false, writes = false;
+
+    std::vector<const llvm::Value*> worklist{arg};
+    std::set<const llvm::Value*> visited{arg};
+    while (!worklist.empty() && !captured)
+    {
+        const auto value = worklist.back();
+        worklist.pop_back();
+
+        for (const auto& use : value->uses())
+        {
+            const auto user = use.getUser();
+            if (llvm::isa<llvm::GetElementPtrInst, llvm::BitCastInst, llvm::PHINode, llvm::SelectInst>(user))
+            {
+                if (visited.insert(user).second) worklist.push_back(user);
+            }
+            else if (const auto load = llvm::dyn_cast<llvm::LoadInst>(user))
+            {
+                reads = true;
+                writes |= load->isVolatile();
+            }
+            else if (const auto store = llvm::dyn_cast<llvm::StoreInst>(user))
+            {
+                if (use.getOperandNo() != llvm::StoreInst::getPointerOperandIndex()) captured = true;
+                writes = true;
+            }
+            else if (const auto call = llvm::dyn_cast<llvm::CallBase>(user))
+            {
+                if (!call->isArgOperand(&use))
+                {
+                    captured = true;
+                    continue;
+                }
+                const auto index = call->getArgOperandNo(&use);
+                captured |= !call->doesNotCapture(index);
+                if (!call->doesNotAccessMemory(index)) reads = true;
+                writes |= !call->onlyReadsMemory(index);
+            }
+            else if (!llvm::isa<llvm::ICmpInst>(user))
+            {
+                // returned, converted to an integer, used by an atomic or anything else unknown
+                captured = true;
+                reads = writes = true;
+            }
+        }
+    }
+
+    if (!captured) arg->addAttr(llvm::Attribute::NoCapture);
+    // an access attribute given by the front end is kept as is
+    if (captured
+        || arg->hasAttribute(llvm::Attribute::ReadNone)
+        || arg->hasAttribute(llvm::Attribute::ReadOnly)
+        || arg->hasAttribute(llvm::Attribute::WriteOnly))
+        return;
+    if (!reads && !writes) arg->addAttr(llvm::Attribute::ReadNone);
+    else if (!writes) arg->addAttr(llvm::Attribute::ReadOnly);
+}
+
+void Brewer::Builder::InferAttributes(llvm::Function* function)
+{
+    if (function->isDeclaration()) return;
+
+    auto nounwind = true, nofree = true, willreturn = true, norecurse = true;
+    auto effects = llvm::MemoryEffects::none();
+
+    // a function that loops may not return
+    llvm::SmallVector<std::pair<const llvm::BasicBlock*, const llvm::BasicBlock*>> backedges;
+    llvm::FindFunctionBackedges(*function, backedges);
+    willreturn = backedges.empty();
+
+    for (auto& block : *function)
+        for (auto& inst : block)
+        {
+            if (const auto load = llvm::dyn_cast<llvm::LoadInst>(&inst))
+            {
+                if (load->isVolatile() || !load->isUnordered()) effects |= llvm::MemoryEffects::unknown();
+                else effects |= get_effects(get_access(load->getPointerOperand()), llvm::ModRefInfo::Ref);
+            }
+            else if (const auto store = llvm::dyn_cast<llvm::StoreInst>(&inst))
+            {
+                if (store->isVolatile() || !store->isUnordered()) effects |= llvm::MemoryEffects::unknown();
+                else effects |= get_effects(get_access(store->getPointerOperand()), llvm::ModRefInfo::Mod);
+            }
+            else if (const auto call = llvm::dyn_cast<llvm::CallBase>(&inst))
+            {
+                // assuming the attributes for the function itself holds for its recursive calls
+                if (call->getCalledFunction() == function)
+                {
+                    norecurse = willreturn = false;
+                    continue;
+                }
+                nounwind &= call->doesNotThrow();
+                nofree &= call->hasFnAttr(llvm::Attribute::NoFree);
+                willreturn &= call->hasFnAttr(llvm::Attribute::WillReturn);
+                norecurse &= does_not_recurse(call->getCalledFunction());
+                effects |= get_call_effects(call);
+            }
+            else if (inst.mayReadOrWriteMemory())
+            {
+                // fences, atomics and whatever else is not handled above
+                effects |= llvm::MemoryEffects::unknown();
+            }
+            else if (llvm::isa<llvm::ResumeInst>(inst))
+            {
+                nounwind = false;
+            }
+        }
+
+    if (nounwind) function->setDoesNotThrow();
+    if (nofree) function->addFnAttr(llvm::Attribute::NoFree);
+    if (willreturn) function->addFnAttr(llvm::Attribute::WillReturn);
+    if (norecurse) function->setDoesNotRecurse();
+    function->setMemoryEffects(function->getMemoryEffects() & effects);
+
+    for (auto& arg : function->args())
+        if (arg.getType()->isPointerTy()) infer_param(&arg);
+}
@@ -1,15 +1,103 @@
 #include <Brewer/Builder.hpp>
+#include <Brewer/Cache.hpp>
 #include <Brewer/Type.hpp>
 #include <Brewer/Util.hpp>
 #include <Brewer/Value.hpp>
+#include <atomic>
+#include <mutex>
+#include <utility>
+#include <llvm/Bitcode/BitcodeReader.h>
+#include <llvm/Bitcode/BitcodeWriter.h>
+#include <llvm/Config/llvm-config.h>
 #include <llvm/IR/LegacyPassManager.h>
 #include <llvm/MC/TargetRegistry.h>
 #include <llvm/Support/FileSystem.h>
+#include <llvm/Support/Path.h>
+#include <llvm/Support/raw_os_ostream.h>
 #include <llvm/Support/raw_ostream.h>
 #include <llvm/Support/TargetSelect.h>
+#include <llvm/Support/ThreadPool.h>
+#include <llvm/Support/TimeProfiler.h>
 #include <llvm/Target/TargetMachine.h>
 #include <llvm/Target/TargetOptions.h>
 #include <llvm/TargetParser/Host.h>
+#include <llvm/Transforms/Utils/Cloning.h>
+#include <llvm/Transforms/Utils/ModuleUtils.h>
+#include <llvm/Transforms/Utils/SplitModule.h>
+
+static const std::map<std::string, Brewer::BinaryFn>& predefined_binary_fns()
+{
+    static const std::map<std::string, Brewer::BinaryFn> fns{
+        {"==", Brewer::Builder::GenEQ},
+        {"!=", Brewer::Builder::GenNE},
+        {"<", Brewer::Builder::GenLT},
+        {">", Brewer::Builder::GenGT},
+        {"<=", Brewer::Builder::GenLE},
+        {">=", Brewer::Builder::GenGE},
+        {"^^", Brewer::Builder::GenLXor},
+        {"+", Brewer::Builder::GenAdd},
+        {"-", Brewer::Builder::GenSub},
+        {"*", Brewer::Builder::GenMul},
+        {"/", Brewer::Builder::GenDiv},
+        {"%", Brewer::Builder::GenRem},
+        {"&", Brewer::Builder::GenAnd},
+        {"|", Brewer::Builder::GenOr},
+        {"^", Brewer::Builder::GenXor},
+        {"<<", Brewer::Builder::GenShl},
+        {">>", Brewer::Builder::GenLShr},
+        {">>>", Brewer::Builder::GenAShr},
+    };
+    return fns;
+}
+
+static const std::map<std::string, Brewer::UnaryFn>& predefined_unary_fns()
+{
+    static const std::map<std::string, Brewer::UnaryFn> fns{
+        {"++", Brewer::Builder::GenInc},
+        {"--", Brewer::Builder::GenDec},
+        {"-", Brewer::Builder::GenNeg},
+        {"!", Brewer::Builder::GenLNot},
+        {"~", Brewer::Builder::GenNot},
+    };
+    return fns;
+}
+
+static const std::map<std::string, Brewer::LazyBinaryFn>& predefined_lazy_binary_fns()
+{
+    static const std::map<std::string, Brewer::LazyBinaryFn> fns{
+        {"&&", Brewer::Builder::GenLAnd},
+        {"||", Brewer::Builder::GenLOr},
+    };
+    return fns;
+}
+
+// 0 if registered locally, 1 if shared, 2 if predefined and 3 if not at all
+template <typename T>
+static int find_level(const std::map<std::string, T>& local,
+                      const std::map<std::string, T>* shared,
+                      const std::map<std::string, T>& predefined,
+                      const std::string& key)
+{
+    if (const auto it = local.find(key); it != local.end() && it->second) return 0;
+    if (shared)
+        if (const auto it = shared->find(key); it != shared->end() && it->second) return 1;
+    if (predefined.count(key)) return 2;
+    return 3;
+}
+
+template <typename T>
+static const T& find_fn(const std::map<std::string, T>& local,
+                        const std::map<std::string, T>* shared,
+                        const std::map<std::string, T>& predefined,
+                        const std::string& key)
+{
+    static const T empty;
+    if (const auto it = local.find(key); it != local.end() && it->second) return it->second;
+    if (shared)
+        if (const auto it = shared->find(key); it != shared->end() && it->second) return it->second;
+    if (const auto it = predefined.find(key); it != predefined.end()) return it->second;
+    return empty;
+}
 
 Brewer::Builder::Builder(Context& context, const std::string& module_id, const std::string& filename)
     : m_Context(context)
@@ -30,33 +118,6 @@ Brewer::Builder::Builder(Context& context, const std::string& module_id, const s
 
     llvm::BasicBlock::Create(*m_IRContext, "entry", m_GlobalCtor);
     llvm::BasicBlock::Create(*m_IRContext, "entry", m_GlobalDtor);
-
-    m_BinaryFns["=="] = GenEQ;
-    m_BinaryFns["!="] = GenNE;
-    m_BinaryFns["<"] = GenLT;
-    m_BinaryFns[">"] = GenGT;
-    m_BinaryFns["<="] = GenLE;
-    m_BinaryFns[">="] = GenGE;
-    m_BinaryFns["&&"] = GenLAnd;
-    m_BinaryFns["||"] = GenLOr;
-    m_BinaryFns["^^"] = GenLXor;
-    m_BinaryFns["+"] = GenAdd;
-    m_BinaryFns["-"] = GenSub;
-    m_BinaryFns["*"] = GenMul;
-    m_BinaryFns["/"] = GenDiv;
-    m_BinaryFns["%"] = GenRem;
-    m_BinaryFns["&"] = GenAnd;
-    m_BinaryFns["|"] = GenOr;
-    m_BinaryFns["^"] = GenXor;
-    m_BinaryFns["<<"] = GenShl;
-    m_BinaryFns[">>"] = GenLShr;
-    m_BinaryFns[">>>"] = GenAShr;
-
-    m_UnaryFns["++"] = GenInc;
-    m_UnaryFns["--"] = GenDec;
-    m_UnaryFns["-"] = GenNeg;
-    m_UnaryFns["!"] = GenLNot;
-    m_UnaryFns["~"] = GenNot;
 }
 
 llvm::Function* Brewer::Builder::GetGlobalCtor() const
@@ -83,6 +144,126 @@ void Brewer::Builder::CloseGlobals() const
         m_IRBuilder->SetInsertPoint(&bb);
         m_IRBuilder->CreateRetVoid();
     }
+
+    // only register the globals if there is anything to run besides the return
+    if (m_GlobalCtor->size() > 1 || m_GlobalCtor->front().size() > 1)
+        llvm::appendToGlobalCtors(*m_IRModule, m_GlobalCtor, 0);
+    if (m_GlobalDtor->size() > 1 || m_GlobalDtor->front().size() > 1)
+        llvm::appendToGlobalDtors(*m_IRModule, m_GlobalDtor, 0);
+}
+
+void Brewer::Builder::SetOptLevel(const unsigned level)
+{
+    m_OptLevel = level;
+    m_Optimizer.reset();
+}
+
+void Brewer::Builder::SetStreaming(const bool mode)
+{
+    m_Streaming = mode;
+}
+
+void Brewer::Builder::SetMergeableStrings(const bool mode)
+{
+    m_MergeableStrings = mode;
+}
+
+void Brewer::Builder::SetFastMathFlags(const llvm::FastMathFlags flags)
+{
+    m_FastMathFlags = flags;
+}
+
+void Brewer::Builder::SetFunctionFastMathFlags(llvm::Function* function, const llvm::FastMathFlags flags)
+{
+    m_FunctionFastMathFlags[function] = flags;
+}
+
+void Brewer::Builder::SetFPContract(const llvm::FPOpFusion::FPOpFusionMode mode)
+{
+    m_FPContract = mode;
+    if (m_TargetMachine) m_TargetMachine->Options.AllowFPOpFusion = mode;
+}
+
+void Brewer::Builder::SelectFastMathFlags()
+{
+    auto flags = m_FastMathFlags;
+    if (const auto block = m_IRBuilder->GetInsertBlock())
+        if (const auto it = m_FunctionFastMathFlags.find(block->getParent()); it != m_FunctionFastMathFlags.end())
+            flags = it->second;
+
+    if (m_FPContract == llvm::FPOpFusion::Fast) flags.setAllowContract(true);
+    m_IRBuilder->setFastMathFlags(flags);
+}
+
+void Brewer::Builder::SetTailCalls(const TailCallMode mode)
+{
+    m_TailCalls = mode;
+}
+
+void Brewer::Builder::SetOverflow(const OverflowMode mode)
+{
+    m_Overflow = mode;
+}
+
+bool Brewer::Builder::HasNSW(const TypePtr& type) const
+{
+    return m_Overflow != OverflowMode_Wrap && type->IsSigned();
+}
+
+bool Brewer::Builder::HasNUW(const TypePtr& type) const
+{
+    return m_Overflow == OverflowMode_NoWrap && type->IsUnsigned();
+}
+
+void Brewer::Builder::SetTiming(Timing* timing)
+{
+    m_Timing = timing;
+}
+
+Brewer::Timing* Brewer::Builder::GetTiming() const
+{
+    return m_Timing;
+}
+
+void Brewer::Builder::CloseFunction(llvm::Function* function)
+{
+    if (m_TailCalls != TailCallMode_None) MarkTailCalls(function);
+    InferAttributes(function);
+    if (m_RecordClosed) m_ClosedFunctions.push_back(function);
+
+    if (!m_Streaming || !m_OptLevel) return;
+    StreamFunction(function);
+}
+
+void Brewer::Builder::RecordClosedFunctions(const bool mode)
+{
+    m_RecordClosed = mode;
+    m_ClosedFunctions.clear();
+}
+
+std::vector<llvm::Function*> Brewer::Builder::TakeClosedFunctions()
+{
+    return std::exchange(m_ClosedFunctions, {});
+}
+
+void Brewer::Builder::Optimize()
+{
+    JoinStreamed();
+
+    if (!m_OptLevel) return;
+    if (!m_Optimizer) m_Optimizer = std::make_unique<Optimizer>(m_OptLevel, GetTargetMachine());
+
+    PhaseScope phase(m_Timing, Phase_Optimize);
+    if (!m_Streaming)
+    {
+        m_Optimizer->Run(*m_IRModule);
+        return;
+    }
+
+    // every function is simplified exactly once, the streamed ones already were
+    for (auto& function : *m_IRModule)
+        if (!m_StreamedFunctions.count(&function)) m_Optimizer->Run(function);
+    m_Optimizer->RunSimplified(*m_IRModule);
 }
 
 Brewer::Context& Brewer::Builder::GetContext() const
@@ -105,6 +286,12 @@ llvm::Module& Brewer::Builder::IRModule() const
     return *m_IRModule;
 }
 
+llvm::orc::ThreadSafeModule Brewer::Builder::TakeModule()
+{
+    JoinStreamed();
+    return {std::move(m_IRModule), std::move(m_IRContext)};
+}
+
 Brewer::BinaryFn& Brewer::Builder::GenBinaryFn(const std::string& operator_)
 {
     return m_BinaryFns[operator_];
@@ -115,62 +302,399 @@ Brewer::UnaryFn& Brewer::Builder::GenUnaryFn(const std::string& operator_)
     return m_UnaryFns[operator_];
 }
 
+Brewer::LazyBinaryFn& Brewer::Builder::GenLazyBinaryFn(const std::string& operator_)
+{
+    return m_LazyBinaryFns[operator_];
+}
+
+void Brewer::Builder::Inherit(const std::map<std::string, BinaryFn>& binary_fns,
+                              const std::map<std::string, UnaryFn>& unary_fns,
+                              const std::map<std::string, LazyBinaryFn>& lazy_binary_fns)
+{
+    m_SharedBinaryFns = &binary_fns;
+    m_SharedUnaryFns = &unary_fns;
+    m_SharedLazyBinaryFns = &lazy_binary_fns;
+}
+
+const Brewer::BinaryFn& Brewer::Builder::GetBinaryFn(const std::string& operator_) const
+{
+    static const BinaryFn empty;
+    const auto eager = find_level(m_BinaryFns, m_SharedBinaryFns, predefined_binary_fns(), operator_);
+    const auto lazy = find_level(m_LazyBinaryFns, m_SharedLazyBinaryFns, predefined_lazy_binary_fns(), operator_);
+    if (lazy < 3 && lazy <= eager) return empty;
+    return find_fn(m_BinaryFns, m_SharedBinaryFns, predefined_binary_fns(), operator_);
+}
+
+const Brewer::LazyBinaryFn& Brewer::Builder::GetLazyBinaryFn(const std::string& operator_) const
+{
+    static const LazyBinaryFn empty;
+    const auto eager = find_level(m_BinaryFns, m_SharedBinaryFns, predefined_binary_fns(), operator_);
+    const auto lazy = find_level(m_LazyBinaryFns, m_SharedLazyBinaryFns, predefined_lazy_binary_fns(), operator_);
+    if (eager < lazy) return empty;
+    return find_fn(m_LazyBinaryFns, m_SharedLazyBinaryFns, predefined_lazy_binary_fns(), operator_);
+}
+
+const Brewer::UnaryFn& Brewer::Builder::GetUnaryFn(const std::string& operator_) const
+{
+    return find_fn(m_UnaryFns, m_SharedUnaryFns, predefined_unary_fns(), operator_);
+}
+
+bool Brewer::Builder::IsPredefinedBinaryFn(const std::string& operator_) const
+{
+    const auto& predefined = predefined_binary_fns();
+    if (const auto it = predefined.find(operator_); it != predefined.end() && &GetBinaryFn(operator_) == &it->second)
+        return true;
+
+    const auto& predefined_lazy = predefined_lazy_binary_fns();
+    const auto it = predefined_lazy.find(operator_);
+    return it != predefined_lazy.end() && &GetLazyBinaryFn(operator_) == &it->second;
+}
+
+bool Brewer::Builder::IsPredefinedUnaryFn(const std::string& operator_) const
+{
+    const auto& predefined = predefined_unary_fns();
+    const auto it = predefined.find(operator_);
+    return it != predefined.end() && &GetUnaryFn(operator_) == &it->second;
+}
+
 void Brewer::Builder::Dump() const
 {
-    m_IRModule->print(llvm::errs(), nullptr);
+    llvm::raw_os_ostream stream(Out());
+    m_IRModule->print(stream, nullptr);
 }
 
-void Brewer::Builder::EmitToFile(const std::string& filename) const
+bool Brewer::Builder::EmitToFile(const std::string& filename, const OutputKind kind)
 {
-    llvm::InitializeAllTargetInfos();
-    llvm::InitializeAllTargets();
-    llvm::InitializeAllTargetMCs();
-    llvm::InitializeAllAsmParsers();
-    llvm::InitializeAllAsmPrinters();
+    const auto text = kind == OutputKind_Assembly || kind == OutputKind_IR;
 
-    const auto triple = llvm::sys::getDefaultTargetTriple();
-    m_IRModule->setTargetTriple(triple);
+    std::error_code ec;
+    llvm::raw_fd_ostream dest(filename, ec, text ? llvm::sys::fs::OF_Text : llvm::sys::fs::OF_None);
 
-    std::string error;
-    const auto target = llvm::TargetRegistry::lookupTarget(triple, error);
+    if (ec)
+    {
+        Err() << "failed to open file: " << ec.message() << std::endl;
+        return false;
+    }
 
-    if (!target)
+    const auto success = Emit(dest, kind);
+    dest.flush();
+    return success;
+}
+
+bool Brewer::Builder::EmitToFiles(const std::vector<Output>& outputs, const unsigned threads, const unsigned partitions)
+{
+    JoinStreamed();
+    if (!GetTargetMachine()) return false;
+
+    // the codegen passes modify the module, so all ir outputs have to be written before the
+    // first machine code output, and every machine code output but the last one runs on a copy
+    std::vector<const Output*> ir;
+    std::vector<const Output*> machine;
+    for (const auto& output : outputs)
     {
-        llvm::errs() << error;
-        return;
+        if (output.Kind == OutputKind_Bitcode || output.Kind == OutputKind_IR) ir.push_back(&output);
+        else machine.push_back(&output);
     }
 
-    const auto cpu = "generic";
-    const auto features = "";
+    bool success = true;
+    for (const auto output : ir)
+        success &= EmitToFile(output->Filename, output->Kind);
 
-    const llvm::TargetOptions opt;
-    const auto machine = target->createTargetMachine(triple, cpu, features, opt, llvm::Reloc::PIC_);
+    if (std::max(threads, partitions) > 1)
+    {
+        // the module is split as a copy, so it stays untouched
+        for (const auto output : machine)
+            success &= EmitToFilesParallel(output->Filename, output->Kind, threads, partitions);
+        return success;
+    }
 
-    m_IRModule->setDataLayout(machine->createDataLayout());
+    for (size_t i = 0; i < machine.size(); ++i)
+    {
+        if (i + 1 == machine.size())
+        {
+            success &= EmitToFile(machine[i]->Filename, machine[i]->Kind);
+            break;
+        }
 
-    std::error_code ec;
-    llvm::raw_fd_ostream dest(filename, ec, llvm::sys::fs::OF_None);
+        auto module = llvm::CloneModule(*m_IRModule);
+        std::swap(m_IRModule, module);
+        success &= EmitToFile(machine[i]->Filename, machine[i]->Kind);
+        std::swap(m_IRModule, module);
+    }
+    return success;
+}
 
-    if (ec)
+bool Brewer::Builder::EmitToFilesParallel(const std::string& filename,
+                                          const OutputKind kind,
+                                          const unsigned threads,
+                                          const unsigned partitions)
+{
+    const auto text = kind == OutputKind_Assembly || kind == OutputKind_IR;
+    const auto count = std::max(threads, partitions);
+
+    std::vector<std::unique_ptr<llvm::raw_fd_ostream>> dests(count);
+    std::vector<llvm::raw_pwrite_stream*> streams(count);
+    for (unsigned i = 0; i < count; ++i)
     {
-        llvm::errs() << "failed to open file: " << ec.message();
-        return;
+        const auto partition = GetPartitionFilename(filename, i);
+
+        std::error_code ec;
+        dests[i] = std::make_unique<llvm::raw_fd_ostream>(partition,
+                                                          ec,
+                                                          text ? llvm::sys::fs::OF_Text : llvm::sys::fs::OF_None);
+        if (ec)
+        {
+            Err() << "failed to open file: " << ec.message() << std::endl;
+            return false;
+        }
+        streams[i] = dests[i].get();
     }
 
+    return EmitParallel(streams, kind, threads);
+}
+
+bool Brewer::Builder::EmitParallel(const llvm::ArrayRef<llvm::raw_pwrite_stream*> streams,
+                                   const OutputKind kind,
+                                   const unsigned threads)
+{
+    JoinStreamed();
+    if (!GetTargetMachine()) return false;
+
+    llvm::TimeTraceScope trace("EmitParallel");
+    PhaseScope phase(m_Timing, Phase_Codegen);
+
+    // the partitions share the module's context, which is not thread safe, so each one is serialized
+    // to bitcode here and parsed back into a context of its own on the worker that generates its code
+    //
+    // splitting turns every local symbol another partition refers to into a hidden external one under its
+    // own name, so the locals of a copy are renamed first, or two modules emitted in parallel would define
+    // the same symbols, e.g. brewer.global_ctor or the pooled strings. the prefix must not depend on the
+    // contents, or a cached partition would never match again after an edit anywhere else
+    const auto module = llvm::CloneModule(*m_IRModule);
+    const auto prefix = Cache::Hash({module->getModuleIdentifier(), module->getSourceFileName()}).substr(0, 16);
+    for (auto& value : module->global_values())
+        if (value.hasLocalLinkage()) value.setName("brewer." + prefix + '.' + value.getName().str());
+
+    std::vector<llvm::SmallVector<char, 0>> partitions;
+    partitions.reserve(streams.size());
+    llvm::SplitModule(*module,
+                      streams.size(),
+                      [&](std::unique_ptr<llvm::Module> partition)
+                      {
+                          llvm::raw_svector_ostream stream(partitions.emplace_back());
+                          llvm::WriteBitcodeToFile(*partition, stream);
+                      });
+
+    std::atomic<bool> failed = false;
+
+    llvm::ThreadPool pool(llvm::hardware_concurrency(threads));
+    for (size_t i = 0; i < partitions.size(); ++i)
+    {
+        pool.async([&, i]
+        {
+            const llvm::MemoryBufferRef buffer({partitions[i].data(), partitions[i].size()},
+                                               GetPartitionFilename(m_IRModule->getModuleIdentifier(), i));
+
+            llvm::LLVMContext context;
+            auto module = llvm::parseBitcodeFile(buffer, context);
+            if (!module)
+            {
+                llvm::consumeError(module.takeError());
+                failed = true;
+                return;
+            }
+
+            if (kind == OutputKind_Bitcode)
+            {
+                llvm::WriteBitcodeToFile(**module, *streams[i]);
+                return;
+            }
+            if (kind == OutputKind_IR)
+            {
+                (*module)->print(*streams[i], nullptr);
+                return;
+            }
+
+            // the code only depends on the partition, the target and the code generation options
+            std::string key;
+            if (m_PartitionCache)
+            {
+                key = Cache::Hash({
+                          "llvm " LLVM_VERSION_STRING,
+                          GetTargetKey(),
+                          std::to_string(m_FPContract),
+                          std::to_string(kind),
+                          llvm::StringRef(partitions[i].data(), partitions[i].size()),
+                      }) + ".part";
+                if (const auto cached = m_PartitionCache->Get(key))
+                {
+                    *streams[i] << cached->getBuffer();
+                    return;
+                }
+            }
+
+            // target machines are not thread safe either, so every worker needs its own
+            const auto machine = CreateTargetMachine();
+            if (!machine)
+            {
+                failed = true;
+                return;
+            }
+            machine->Options.AllowFPOpFusion = m_FPContract;
+
+            const auto file_type = kind == OutputKind_Assembly
+                                       ? llvm::CodeGenFileType::AssemblyFile
+                                       : llvm::CodeGenFileType::ObjectFile;
+
+            llvm::SmallVector<char, 0> code;
+            llvm::raw_svector_ostream dest(code);
+
+            llvm::legacy::PassManager pass;
+            if (machine->addPassesToEmitFile(pass, m_PartitionCache ? dest : *streams[i], nullptr, file_type))
+            {
+                failed = true;
+                return;
+            }
+
+            pass.run(**module);
+
+            if (!m_PartitionCache) return;
+            const llvm::StringRef data(code.data(), code.size());
+            *streams[i] << data;
+            m_PartitionCache->Put(key, data);
+        });
+    }
+    pool.wait();
+
+    if (failed)
+    {
+        Err() << "failed to emit partitions" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void Brewer::Builder::SetPartitionCache(std::shared_ptr<Cache> cache)
+{
+    m_PartitionCache = std::move(cache);
+}
+
+std::string Brewer::Builder::GetPartitionFilename(const std::string& filename, const unsigned partition)
+{
+    llvm::SmallString<128> path(filename);
+    const auto extension = llvm::sys::path::extension(filename).str();
+    llvm::sys::path::replace_extension(path, "." + std::to_string(partition) + extension);
+    return path.str().str();
+}
+
+bool Brewer::Builder::EmitToBuffer(llvm::SmallVectorImpl<char>& buffer, const OutputKind kind)
+{
+    llvm::raw_svector_ostream dest(buffer);
+    return Emit(dest, kind);
+}
+
+bool Brewer::Builder::Emit(llvm::raw_pwrite_stream& stream, const OutputKind kind)
+{
+    JoinStreamed();
+    const auto machine = GetTargetMachine();
+    if (!machine) return false;
+
+    llvm::TimeTraceScope trace("Emit");
+    PhaseScope phase(m_Timing, Phase_Codegen);
+
+    switch (kind)
+    {
+    case OutputKind_Bitcode:
+        llvm::WriteBitcodeToFile(*m_IRModule, stream);
+        return true;
+    case OutputKind_IR:
+        m_IRModule->print(stream, nullptr);
+        return true;
+    default:
+        break;
+    }
+
+    const auto file_type = kind == OutputKind_Assembly
+                               ? llvm::CodeGenFileType::AssemblyFile
+                               : llvm::CodeGenFileType::ObjectFile;
+
     llvm::legacy::PassManager pass;
-    if (machine->addPassesToEmitFile(pass, dest, nullptr, llvm::CodeGenFileType::ObjectFile))
+    if (machine->addPassesToEmitFile(pass, stream, nullptr, file_type))
     {
-        llvm::errs() << "failed to emit to file";
-        return;
+        Err() << "failed to emit to file" << std::endl;
+        return false;
     }
 
     pass.run(*m_IRModule);
-    dest.flush();
+    return true;
+}
+
+llvm::TargetMachine* Brewer::Builder::GetTargetMachine()
+{
+    if (m_TargetMachine)
+        return m_TargetMachine.get();
+
+    m_TargetMachine = CreateTargetMachine();
+    if (!m_TargetMachine)
+        return nullptr;
+
+    m_TargetMachine->Options.AllowFPOpFusion = m_FPContract;
+
+    m_IRModule->setTargetTriple(m_TargetMachine->getTargetTriple().str());
+    m_IRModule->setDataLayout(m_TargetMachine->createDataLayout());
+    return m_TargetMachine.get();
+}
+
+const std::string& Brewer::Builder::GetTargetKey()
+{
+    static const std::string key = []
+    {
+        const auto machine = CreateTargetMachine();
+        if (!machine) return std::string();
+        return machine->getTargetTriple().str()
+               + ';' + machine->getTargetCPU().str()
+               + ';' + machine->getTargetFeatureString().str();
+    }();
+    return key;
+}
+
+std::unique_ptr<llvm::TargetMachine> Brewer::Builder::CreateTargetMachine()
+{
+    static std::once_flag initialized;
+    std::call_once(initialized,
+                   []
+                   {
+                       llvm::InitializeAllTargetInfos();
+                       llvm::InitializeAllTargets();
+                       llvm::InitializeAllTargetMCs();
+                       llvm::InitializeAllAsmParsers();
+                       llvm::InitializeAllAsmPrinters();
+                   });
+
+    const auto triple = llvm::sys::getDefaultTargetTriple();
+
+    std::string error;
+    const auto target = llvm::TargetRegistry::lookupTarget(triple, error);
+
+    if (!target)
+    {
+        Err() << error << std::endl;
+        return {};
+    }
+
+    const auto cpu = "generic";
+    const auto features = "";
+
+    const llvm::TargetOptions opt;
+    return std::unique_ptr<llvm::TargetMachine>(
+        target->createTargetMachine(triple, cpu, features, opt, llvm::Reloc::PIC_));
 }
 
 Brewer::ValuePtr& Brewer::Builder::GetFunction(const TypePtr& self, const std::string& name)
 {
-    return m_Functions[self][name];
+    auto& function = m_Functions[self][name];
+    if (!function && !self) function = GetIntrinsic(name);
+    return function;
 }
 
 Brewer::ValuePtr Brewer::Builder::GetCtor(const TypePtr& type)
@@ -222,10 +746,12 @@ Brewer::ValuePtr Brewer::Builder::GenCast(const ValuePtr& src, const TypePtr& ds
         switch (dst->GetID())
         {
         case Type_Integer:
-            result = m_IRBuilder->CreateIntCast(src->Get(), type, true);
+            result = m_IRBuilder->CreateIntCast(src->Get(), type, src_type->IsSigned());
             break;
         case Type_Float:
-            result = m_IRBuilder->CreateSIToFP(src->Get(), type);
+            result = src_type->IsUnsigned()
+                         ? m_IRBuilder->CreateUIToFP(src->Get(), type)
+                         : m_IRBuilder->CreateSIToFP(src->Get(), type);
             break;
         case Type_Pointer:
             result = m_IRBuilder->CreateIntToPtr(src->Get(), type);
@@ -238,7 +764,9 @@ Brewer::ValuePtr Brewer::Builder::GenCast(const ValuePtr& src, const TypePtr& ds
         switch (dst->GetID())
         {
         case Type_Integer:
-            result = m_IRBuilder->CreateFPToSI(src->Get(), type);
+            result = dst->IsUnsigned()
+                         ? m_IRBuilder->CreateFPToUI(src->Get(), type)
+                         : m_IRBuilder->CreateFPToSI(src->Get(), type);
             break;
         case Type_Float:
             result = m_IRBuilder->CreateFPCast(src->Get(), type);
@@ -265,10 +793,41 @@ Brewer::ValuePtr Brewer::Builder::GenCast(const ValuePtr& src, const TypePtr& ds
     }
 
     if (!result)
-        return std::cerr
+        return Err()
             << "cannot cast from " << src_type->GetName() << " to " << dst->GetName()
             << std::endl
             << ErrMark<ValuePtr>();
 
     return RValue::Direct(*this, dst, result);
 }
+
+llvm::Constant* Brewer::Builder::GetString(const std::string& value)
+{
+    auto& global = m_Strings[value];
+    if (global) return global;
+
+    const auto data = llvm::ConstantDataArray::getString(*m_IRContext, value);
+
+    std::string name = ".str";
+    if (m_MergeableStrings)
+    {
+        name += '.' + Cache::Hash({value});
+        if ((global = m_IRModule->getNamedGlobal(name))) return global;
+    }
+
+    global = new llvm::GlobalVariable(*m_IRModule,
+                                      data->getType(),
+                                      true,
+                                      m_MergeableStrings
+                                          ? llvm::GlobalValue::LinkOnceODRLinkage
+                                          : llvm::GlobalValue::PrivateLinkage,
+                                      data,
+                                      name);
+    global->setUnnamedAddr(llvm::GlobalValue::UnnamedAddr::Global);
+    global->setAlignment(llvm::Align(1));
+
+    if (m_MergeableStrings && llvm::Triple(m_IRModule->getTargetTriple()).supportsCOMDAT())
+        global->setComdat(m_IRModule->getOrInsertComdat(name));
+
+    return global;
+}
@@ -0,0 +1,162 @@
+#include <algorithm>
+#include <vector>
+#include <Brewer/Cache.hpp>
+#include <Brewer/Util.hpp>
+#include <llvm/ADT/StringExtras.h>
+#include <llvm/Support/Chrono.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/Path.h>
+#include <llvm/Support/Process.h>
+#include <llvm/Support/raw_ostream.h>
+#include <llvm/Support/SHA1.h>
+
+std::string Brewer::Cache::Hash(const llvm::ArrayRef<llvm::StringRef> parts)
+{
+    llvm::SHA1 sha;
+    for (const auto& part : parts)
+    {
+        // length prefix, so that the concatenation of parts cannot collide
+        const auto size = static_cast<uint64_t>(part.size());
+        sha.update(llvm::ArrayRef(reinterpret_cast<const uint8_t*>(&size), sizeof(size)));
+        sha.update(part);
+    }
+    return llvm::toHex(sha.final(), true);
+}
+
+Brewer::Cache::Cache(std::string directory, const uint64_t max_size)
+    : m_Directory(std::move(directory)), m_MaxSize(max_size)
+{
+    if (const auto ec = llvm::sys::fs::create_directories(m_Directory))
+        Err() << "failed to create cache directory '" << m_Directory << "': " << ec.message() << std::endl;
+}
+
+const std::string& Brewer::Cache::GetDirectory() const
+{
+    return m_Directory;
+}
+
+size_t Brewer::Cache::GetHits() const
+{
+    return m_Hits;
+}
+
+size_t Brewer::Cache::GetMisses() const
+{
+    return m_Misses;
+}
+
+std::unique_ptr<llvm::MemoryBuffer> Brewer::Cache::Get(const std::string& key)
+{
+    llvm::SmallString<128> path(m_Directory);
+    llvm::sys::path::append(path, key);
+
+    int fd;
+    if (llvm::sys::fs::openFileForRead(path, fd))
+    {
+        ++m_Misses;
+        return {};
+    }
+
+    auto buffer = llvm::MemoryBuffer::getOpenFile(llvm::sys::fs::convertFDToNativeFile(fd), path, -1, false);
+
+    // touching the entry on every hit turns the modification time into a last use time for the eviction
+    llvm::sys::fs::setLastAccessAndModificationTime(fd, std::chrono::system_clock::now());
+    llvm::sys::Process::SafelyCloseFileDescriptor(fd);
+
+    if (!buffer)
+    {
+        ++m_Misses;
+        return {};
+    }
+
+    ++m_Hits;
+    return std::move(*buffer);
+}
+
+void Brewer::Cache::Put(const std::string& key, const llvm::StringRef data)
+{
+    llvm::SmallString<128> path(m_Directory);
+    llvm::sys::path::append(path, key);
+
+    // write to a unique temporary and rename it into place, so readers never see a partial entry
+    int fd;
+    llvm::SmallString<128> temp;
+    if (const auto ec = llvm::sys::fs::createUniqueFile(path + ".tmp-%%%%%%%%", fd, temp))
+    {
+        Err() << "failed to create cache entry '" << path.str().str() << "': " << ec.message() << std::endl;
+        return;
+    }
+
+    {
+        llvm::raw_fd_ostream stream(fd, true);
+        stream << data;
+        stream.close();
+        if (stream.has_error())
+        {
+            stream.clear_error();
+            llvm::sys::fs::remove(temp);
+            return;
+        }
+    }
+
+    if (const auto ec = llvm::sys::fs::rename(temp, path))
+    {
+        Err() << "failed to commit cache entry '" << path.str().str() << "': " << ec.message() << std::endl;
+        llvm::sys::fs::remove(temp);
+        return;
+    }
+
+    {
+        const std::lock_guard lock(m_Mutex);
+        m_Size += data.size();
+        if (!m_MaxSize || (m_SizeKnown && m_Size <= m_MaxSize)) return;
+    }
+
+    Prune();
+}
+
+void Brewer::Cache::Prune()
+{
+    struct Entry
+    {
+        std::string Path;
+        uint64_t Size;
+        llvm::sys::TimePoint<> Time;
+    };
+
+    const std::lock_guard lock(m_Mutex);
+
+    std::vector<Entry> entries;
+    uint64_t size = 0;
+
+    std::error_code ec;
+    for (llvm::sys::fs::directory_iterator it(m_Directory, ec), end; it != end && !ec; it.increment(ec))
+    {
+        if (llvm::StringRef(it->path()).contains(".tmp-")) continue;
+
+        llvm::sys::fs::file_status status;
+        if (llvm::sys::fs::status(it->path(), status) || status.type() != llvm::sys::fs::file_type::regular_file)
+            continue;
+
+        entries.push_back({it->path(), status.getSize(), status.getLastModificationTime()});
+        size += status.getSize();
+    }
+
+    if (m_MaxSize && size > m_MaxSize)
+    {
+        // least recently used first
+        std::sort(entries.begin(),
+                  entries.end(),
+                  [](const Entry& a, const Entry& b) { return a.Time < b.Time; });
+
+        for (const auto& [Path, Size, Time] : entries)
+        {
+            if (size <= m_MaxSize) break;
+            if (llvm::sys::fs::remove(Path)) continue;
+            size -= Size;
+        }
+    }
+
+    m_Size = size;
+    m_SizeKnown = true;
+}
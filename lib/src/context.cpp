@@ -9,6 +9,10 @@ Brewer::Context::Context()
     m_Types["i16"] = std::make_shared<Type>(*this, "i16", Type_Integer, 16);
     m_Types["i32"] = std::make_shared<Type>(*this, "i32", Type_Integer, 32);
     m_Types["i64"] = std::make_shared<Type>(*this, "i64", Type_Integer, 64);
+    m_Types["u8"] = std::make_shared<Type>(*this, "u8", Type_Integer, 8, false);
+    m_Types["u16"] = std::make_shared<Type>(*this, "u16", Type_Integer, 16, false);
+    m_Types["u32"] = std::make_shared<Type>(*this, "u32", Type_Integer, 32, false);
+    m_Types["u64"] = std::make_shared<Type>(*this, "u64", Type_Integer, 64, false);
     m_Types["f16"] = std::make_shared<Type>(*this, "f16", Type_Float, 16);
     m_Types["f32"] = std::make_shared<Type>(*this, "f32", Type_Float, 32);
     m_Types["f64"] = std::make_shared<Type>(*this, "f64", Type_Float, 64);
@@ -19,6 +23,11 @@ Brewer::TypePtr& Brewer::Context::GetType(const std::string& name)
     return m_Types[name];
 }
 
+size_t Brewer::Context::GetTypeCount() const
+{
+    return m_Types.size();
+}
+
 Brewer::TypePtr Brewer::Context::GetVoidTy()
 {
     return m_Types["void"];
@@ -62,6 +71,18 @@ Brewer::TypePtr Brewer::Context::GetInt64Ty()
     return m_Types["i64"];
 }
 
+Brewer::TypePtr Brewer::Context::GetUIntNTy(size_t n)
+{
+    switch (n)
+    {
+    case 8: return m_Types["u8"];
+    case 16: return m_Types["u16"];
+    case 32: return m_Types["u32"];
+    case 64: return m_Types["u64"];
+    default: return {};
+    }
+}
+
 Brewer::TypePtr Brewer::Context::GetFloatNTy(size_t n)
 {
     switch (n)
@@ -0,0 +1,76 @@
+#include <Brewer/AST.hpp>
+#include <Brewer/Builder.hpp>
+
+void Brewer::Builder::Defer(const std::string& name, StmtPtr statement, DeferredFn generate)
+{
+    statement->Declare(*this);
+    // like an eager build, the first definition wins
+    m_Deferred.emplace(name, std::pair{std::move(statement), std::move(generate)});
+}
+
+void Brewer::Builder::Require(const std::string& name)
+{
+    const auto it = m_Deferred.find(name);
+    if (it == m_Deferred.end()) return;
+
+    // taken out first, so a recursive reference finds the declaration and nothing to generate
+    const auto [statement, generate] = std::move(it->second);
+    m_Deferred.erase(it);
+
+    // the body is generated as if it were at the top level, not inside the function that referenced it
+    llvm::IRBuilderBase::InsertPointGuard insert_point(*m_IRBuilder);
+    llvm::IRBuilderBase::FastMathFlagGuard fast_math(*m_IRBuilder);
+    // the function belongs to none of the statements being recorded for an incremental build
+    const auto closed = std::exchange(m_ClosedFunctions, {});
+    const auto stack = std::exchange(m_Stack, {});
+    const auto symbols = m_Symbols;
+    const auto result = m_CurrentResult;
+    if (!stack.empty()) m_Symbols = stack.front();
+
+    m_IRBuilder->SetInsertPoint(&m_GlobalCtor->back());
+    if (generate) generate(*this, *statement);
+    else statement->GenIRNoVal(*this);
+
+    m_ClosedFunctions = closed;
+    m_Stack = stack;
+    m_Symbols = symbols;
+    m_CurrentResult = result;
+}
+
+void Brewer::Builder::CloseDeferred()
+{
+    // without exports every definition is visible, so all of them are generated
+    if (m_Exports.empty())
+        while (!m_Deferred.empty())
+            Require(m_Deferred.begin()->first);
+
+    for (const auto& name : m_Exports)
+        Require(name);
+
+    // bodies loaded from fragments refer to functions without going through a symbol expression
+    for (auto required = true; required;)
+    {
+        required = false;
+        std::vector<std::string> names;
+        for (const auto& [name, statement] : m_Deferred)
+            names.push_back(name);
+        for (const auto& name : names)
+        {
+            const auto function = m_IRModule->getFunction(name);
+            if (!function || function->use_empty() || !m_Deferred.count(name)) continue;
+            Require(name);
+            required = true;
+        }
+    }
+
+    // whatever is left was never referenced, so neither its body nor its declaration is needed
+    for (const auto& [name, statement] : m_Deferred)
+    {
+        const auto function = m_IRModule->getFunction(name);
+        if (!function || !function->isDeclaration() || !function->use_empty()) continue;
+        m_Functions[{}].erase(name);
+        m_FunctionFastMathFlags.erase(function);
+        function->eraseFromParent();
+    }
+    m_Deferred.clear();
+}
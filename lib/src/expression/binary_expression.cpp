@@ -23,6 +23,19 @@ std::ostream& Brewer::BinaryExpression::Dump(std::ostream& stream) const
 
 Brewer::ValuePtr Brewer::BinaryExpression::GenIR(Builder& builder) const
 {
+    if (const auto& fn = builder.GetLazyBinaryFn(Operator))
+    {
+        if (auto result = fn(builder, *LHS, *RHS, {}))
+            return result;
+
+        return Err()
+            << "at " << Location << ": "
+            << "undefined binary operator "
+            << "'" << LHS->Type << " " << Operator << RHS->Type << "'"
+            << std::endl
+            << ErrMark<ValuePtr>();
+    }
+
     const auto lhs = LHS->GenIR(builder);
     if (!lhs) return {};
     const auto rhs = RHS->GenIR(builder);
@@ -37,7 +50,7 @@ Brewer::ValuePtr Brewer::BinaryExpression::GenIR(Builder& builder) const
             return dest;
         }
 
-        return std::cerr
+        return Err()
             << "at " << Location << ": "
             << "cannot assign to rvalue"
             << std::endl
@@ -57,12 +70,16 @@ Brewer::ValuePtr Brewer::BinaryExpression::GenIR(Builder& builder) const
         if (!r) return {};
     }
 
-    if (const auto& fn = builder.GenBinaryFn(Operator))
+    // the flags apply to this operator only, not to whatever the builder creates after it
+    llvm::IRBuilderBase::FastMathFlagGuard fast_math(builder.IRBuilder());
+    builder.SelectFastMathFlags();
+
+    if (const auto& fn = builder.GetBinaryFn(Operator))
     {
         if (auto result = fn(builder, l, r, {}))
             return result;
 
-        return std::cerr
+        return Err()
             << "at " << Location << ": "
             << "undefined binary operator "
             << "'" << lhs->GetType() << " " << Operator << rhs->GetType() << "'"
@@ -73,7 +90,7 @@ Brewer::ValuePtr Brewer::BinaryExpression::GenIR(Builder& builder) const
     if (const auto pos = Operator.find('='); pos != std::string::npos)
     {
         const auto op = Operator.substr(0, pos);
-        if (const auto& fn = builder.GenBinaryFn(op))
+        if (const auto& fn = builder.GetBinaryFn(op))
         {
             if (const auto result = fn(builder, l, r, {}))
             {
@@ -84,7 +101,7 @@ Brewer::ValuePtr Brewer::BinaryExpression::GenIR(Builder& builder) const
                     return dest;
                 }
 
-                return std::cerr
+                return Err()
                     << "at " << Location << ": "
                     << "cannot assign to rvalue"
                     << std::endl
@@ -93,7 +110,7 @@ Brewer::ValuePtr Brewer::BinaryExpression::GenIR(Builder& builder) const
         }
     }
 
-    return std::cerr
+    return Err()
         << "at " << Location << ": "
         << "undefined binary operator "
         << "'" << lhs->GetType() << " " << Operator << rhs->GetType() << "'"
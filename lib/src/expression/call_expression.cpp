@@ -28,7 +28,7 @@ Brewer::ValuePtr Brewer::CallExpression::GenIR(Builder& builder) const
 
     const auto type = FunctionType::From(PointerType::From(callee->GetType())->GetBase());
     if (!type)
-        return std::cerr
+        return Err()
             << "at " << Location << ": "
             << "callee must be a function pointer"
             << std::endl
@@ -73,14 +73,27 @@ Brewer::ValuePtr Brewer::CallExpression::GenIR(Builder& builder) const
         args[i] = arg->Get();
     }
 
-    const auto result = builder.IRBuilder().CreateCall(ty, callee->Get(), args);
+    // intrinsics take their constant extra arguments, e.g. the volatile flag of memcpy, right at the call site,
+    // so no wrapper has to be inlined even at -O0
+    llvm::FunctionType* call_ty = ty;
+    if (const auto extra = builder.GetIntrinsicExtra(callee); !extra.empty())
+    {
+        args.insert(args.end(), extra.begin(), extra.end());
+        call_ty = llvm::cast<llvm::Function>(callee->Get())->getFunctionType();
+    }
+
+    const auto result = builder.IRBuilder().CreateCall(call_ty, callee->Get(), args);
     if (!result)
-        return std::cerr
+        return Err()
             << "at " << Location << ": "
             << "failed to create call"
             << std::endl
             << ErrMark<ValuePtr>();
 
+    // the callee may use another calling convention than c, e.g. fastcc for internal functions
+    if (const auto function = llvm::dyn_cast<llvm::Function>(callee->Get()))
+        result->setCallingConv(function->getCallingConv());
+
     if (type->GetMode() == FuncMode_Ctor)
         return self;
 
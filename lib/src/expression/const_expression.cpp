@@ -56,8 +56,8 @@ std::ostream& Brewer::ConstFloatExpression::Dump(std::ostream& stream) const
 
 Brewer::ValuePtr Brewer::ConstFloatExpression::GenIR(Builder& builder) const
 {
-    const auto value = llvm::ConstantFP::get(builder.IRBuilder().getDoubleTy(), Value);
-    return RValue::Direct(builder, Type::Get(builder.GetContext(), "f64"), value);
+    const auto value = llvm::ConstantFP::get(Type->GenIR(builder), Value);
+    return RValue::Direct(builder, Type, value);
 }
 
 Brewer::ConstIntExpression::ConstIntExpression(const SourceLocation& loc, const TypePtr& type, const size_t value)
@@ -72,8 +72,8 @@ std::ostream& Brewer::ConstIntExpression::Dump(std::ostream& stream) const
 
 Brewer::ValuePtr Brewer::ConstIntExpression::GenIR(Builder& builder) const
 {
-    const auto value = builder.IRBuilder().getInt64(Value);
-    return RValue::Direct(builder, Type::Get(builder.GetContext(), "i64"), value);
+    const auto value = llvm::ConstantInt::get(Type->GenIR(builder), Value);
+    return RValue::Direct(builder, Type, value);
 }
 
 Brewer::ConstStringExpression::ConstStringExpression(const SourceLocation& loc, const TypePtr& type, std::string value)
@@ -88,6 +88,6 @@ std::ostream& Brewer::ConstStringExpression::Dump(std::ostream& stream) const
 
 Brewer::ValuePtr Brewer::ConstStringExpression::GenIR(Builder& builder) const
 {
-    const auto value = builder.IRBuilder().CreateGlobalStringPtr(Value);
+    const auto value = builder.GetString(Value);
     return RValue::Direct(builder, PointerType::Get(Type::Get(builder.GetContext(), "i8")), value);
 }
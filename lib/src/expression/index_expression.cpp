@@ -35,7 +35,7 @@ Brewer::ValuePtr Brewer::IndexExpression::GenIR(Builder& builder) const
         return LValue::Direct(builder, Type, gep);
     }
 
-    return std::cerr
+    return Err()
         << "at " << Location << ": "
         << "can only index into pointer or array"
         << std::endl
@@ -39,7 +39,7 @@ Brewer::ValuePtr Brewer::MemberExpression::GenIR(Builder& builder) const
 
     const auto l_object = LValue::From(object);
     if (!l_object)
-        return std::cerr
+        return Err()
             << "at " << Location << ": "
             << "cannot get member of constant struct"
             << std::endl
@@ -15,8 +15,10 @@ std::ostream& Brewer::SymbolExpression::Dump(std::ostream& stream) const
 Brewer::ValuePtr Brewer::SymbolExpression::GenIR(Builder& builder) const
 {
     if (const auto& value = builder.GetSymbol(Name)) return value;
+    // calls reach this through their callee, so both generate a deferred function on first use
+    builder.Require(Name);
     if (const auto& value = builder.GetFunction({}, Name)) return value;
-    return std::cerr
+    return Err()
         << "at " << Location << ": "
         << "no such symbol '" << Name << "'"
         << std::endl
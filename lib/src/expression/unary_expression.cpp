@@ -25,7 +25,11 @@ Brewer::ValuePtr Brewer::UnaryExpression::GenIR(Builder& builder) const
     const auto operand = Operand->GenIR(builder);
     if (!operand) return {};
 
-    if (const auto& fn = builder.GenUnaryFn(Operator))
+    // the flags apply to this operator only, not to whatever the builder creates after it
+    llvm::IRBuilderBase::FastMathFlagGuard fast_math(builder.IRBuilder());
+    builder.SelectFastMathFlags();
+
+    if (const auto& fn = builder.GetUnaryFn(Operator))
     {
         const bool assign = Operator == "++" || Operator == "--";
         if (auto result = fn(builder, operand, nullptr))
@@ -41,7 +45,7 @@ Brewer::ValuePtr Brewer::UnaryExpression::GenIR(Builder& builder) const
                     return RValue::Direct(builder, operand->GetType(), pre);
                 }
 
-                return std::cerr << "at " << Location << ": "
+                return Err() << "at " << Location << ": "
                     << "cannot assign to rvalue"
                     << std::endl
                     << ErrMark<ValuePtr>();
@@ -50,7 +54,7 @@ Brewer::ValuePtr Brewer::UnaryExpression::GenIR(Builder& builder) const
         }
     }
 
-    return std::cerr << "at " << Location << ": "
+    return Err() << "at " << Location << ": "
         << "undefined unary operator "
         << "'" << Operator << operand->GetType()->GetName() << "'"
         << std::endl
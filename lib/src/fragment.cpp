@@ -0,0 +1,239 @@
+#include <set>
+#include <Brewer/Builder.hpp>
+#include <llvm/Bitcode/BitcodeReader.h>
+#include <llvm/Bitcode/BitcodeWriter.h>
+#include <llvm/IR/Constants.h>
+#include <llvm/Transforms/Utils/Cloning.h>
+#include <llvm/Transforms/Utils/ValueMapper.h>
+
+static void collect_globals(const llvm::Value* value,
+                            std::set<const llvm::Value*>& visited,
+                            std::vector<llvm::GlobalValue*>& globals)
+{
+    if (!visited.insert(value).second) return;
+
+    if (const auto global = llvm::dyn_cast<llvm::GlobalValue>(value))
+    {
+        globals.push_back(const_cast<llvm::GlobalValue*>(global));
+        return;
+    }
+
+    if (const auto constant = llvm::dyn_cast<llvm::Constant>(value))
+        for (const auto& operand : constant->operands())
+            collect_globals(operand, visited, globals);
+}
+
+// constant data only the fragment refers to, like string literals, is carried along
+static bool is_carried(const llvm::GlobalValue* global)
+{
+    const auto variable = llvm::dyn_cast<llvm::GlobalVariable>(global);
+    return variable
+        && (variable->hasLocalLinkage() || variable->hasLinkOnceODRLinkage())
+        && variable->isConstant()
+        && variable->hasInitializer();
+}
+
+// the contents of a string literal from the builder's pool
+static const llvm::ConstantDataArray* get_pooled_string(const llvm::GlobalVariable* variable)
+{
+    if (!variable->hasGlobalUnnamedAddr()) return nullptr;
+    const auto data = llvm::dyn_cast<llvm::ConstantDataArray>(variable->getInitializer());
+    return data && data->isCString() ? data : nullptr;
+}
+
+// what InferAttributes derived from the callees may no longer hold for them, since loading a fragment only
+// checks the callees' types
+static void strip_inferred(llvm::Function* function)
+{
+    for (const auto kind : {llvm::Attribute::NoUnwind,
+                            llvm::Attribute::NoFree,
+                            llvm::Attribute::WillReturn,
+                            llvm::Attribute::NoRecurse,
+                            llvm::Attribute::Memory})
+        function->removeFnAttr(kind);
+    for (auto& arg : function->args())
+        for (const auto kind : {llvm::Attribute::NoCapture, llvm::Attribute::ReadNone, llvm::Attribute::ReadOnly})
+            arg.removeAttr(kind);
+}
+
+std::string Brewer::Builder::SaveFragment(const llvm::ArrayRef<llvm::Function*> functions) const
+{
+    llvm::Module fragment(m_IRModule->getModuleIdentifier(), *m_IRContext);
+    fragment.setTargetTriple(m_IRModule->getTargetTriple());
+    fragment.setDataLayout(m_IRModule->getDataLayout());
+
+    llvm::ValueToValueMapTy map;
+    for (const auto function : functions)
+        map[function] = llvm::Function::Create(function->getFunctionType(),
+                                               function->getLinkage(),
+                                               function->getName(),
+                                               fragment);
+
+    std::set<const llvm::Value*> visited(functions.begin(), functions.end());
+    std::vector<llvm::GlobalValue*> globals;
+    for (const auto function : functions)
+        for (const auto& block : *function)
+            for (const auto& inst : block)
+                for (const auto& operand : inst.operands())
+                    collect_globals(operand, visited, globals);
+
+    std::vector<llvm::GlobalVariable*> carried;
+    for (size_t i = 0; i < globals.size(); ++i)
+    {
+        const auto global = globals[i];
+        if (const auto function = llvm::dyn_cast<llvm::Function>(global))
+        {
+            // the attributes tell the streaming worker what the callee does, e.g. that it does not write memory
+            const auto copy = llvm::Function::Create(function->getFunctionType(),
+                                                     llvm::GlobalValue::ExternalLinkage,
+                                                     function->getName(),
+                                                     fragment);
+            copy->setAttributes(function->getAttributes());
+            copy->setCallingConv(function->getCallingConv());
+            map[global] = copy;
+            continue;
+        }
+
+        const auto variable = llvm::cast<llvm::GlobalVariable>(global);
+        if (is_carried(variable))
+        {
+            carried.push_back(variable);
+            map[global] = new llvm::GlobalVariable(fragment,
+                                                   variable->getValueType(),
+                                                   true,
+                                                   variable->getLinkage(),
+                                                   nullptr,
+                                                   variable->getName());
+            collect_globals(variable->getInitializer(), visited, globals);
+            continue;
+        }
+
+        map[global] = new llvm::GlobalVariable(fragment,
+                                               variable->getValueType(),
+                                               variable->isConstant(),
+                                               llvm::GlobalValue::ExternalLinkage,
+                                               nullptr,
+                                               variable->getName());
+    }
+
+    for (const auto variable : carried)
+    {
+        const auto copy = llvm::cast<llvm::GlobalVariable>(map[variable]);
+        copy->setInitializer(llvm::MapValue(variable->getInitializer(), map));
+        copy->setUnnamedAddr(variable->getUnnamedAddr());
+        copy->setAlignment(variable->getAlign());
+    }
+
+    for (const auto function : functions)
+    {
+        const auto copy = llvm::cast<llvm::Function>(map[function]);
+        for (size_t i = 0; i < function->arg_size(); ++i)
+            map[function->getArg(i)] = copy->getArg(i);
+
+        llvm::SmallVector<llvm::ReturnInst*, 8> returns;
+        llvm::CloneFunctionInto(copy, function, map, llvm::CloneFunctionChangeType::DifferentModule, returns);
+    }
+
+    std::string data;
+    llvm::raw_string_ostream stream(data);
+    llvm::WriteBitcodeToFile(fragment, stream);
+    stream.flush();
+    return data;
+}
+
+bool Brewer::Builder::LoadFragment(const llvm::StringRef fragment)
+{
+    auto module = llvm::parseBitcodeFile(llvm::MemoryBufferRef(fragment, "fragment"), *m_IRContext);
+    if (!module)
+    {
+        llvm::consumeError(module.takeError());
+        return false;
+    }
+
+    // check everything before touching the module, so that a mismatch leaves it as it was
+    llvm::ValueToValueMapTy map;
+    std::vector<std::pair<llvm::Function*, llvm::Function*>> bodies;
+    std::vector<llvm::GlobalVariable*> carried;
+    std::vector<llvm::Function*> intrinsics;
+    for (auto& global : (*module)->global_values())
+    {
+        if (is_carried(&global))
+        {
+            carried.push_back(llvm::cast<llvm::GlobalVariable>(&global));
+            continue;
+        }
+
+        const auto dest = m_IRModule->getNamedValue(global.getName());
+
+        // optimizing a fragment may introduce intrinsics the module has not used yet, e.g. llvm.smax
+        if (const auto function = llvm::dyn_cast<llvm::Function>(&global); !dest && function && function->isIntrinsic())
+        {
+            intrinsics.push_back(function);
+            continue;
+        }
+
+        if (!dest
+            || dest->getValueType() != global.getValueType()
+            || llvm::isa<llvm::Function>(dest) != llvm::isa<llvm::Function>(&global))
+            return false;
+
+        if (!global.isDeclaration())
+        {
+            // the statement declared the function, but must not have defined it yet
+            if (!dest->isDeclaration()) return false;
+            bodies.emplace_back(llvm::cast<llvm::Function>(&global), llvm::cast<llvm::Function>(dest));
+        }
+
+        map[&global] = dest;
+    }
+
+    for (const auto intrinsic : intrinsics)
+        map[intrinsic] = llvm::Function::Create(intrinsic->getFunctionType(),
+                                                llvm::GlobalValue::ExternalLinkage,
+                                                intrinsic->getName(),
+                                                *m_IRModule);
+
+    for (const auto variable : carried)
+    {
+        // strings go back into the pool, so the module still has a single constant per string
+        if (const auto data = get_pooled_string(variable))
+        {
+            map[variable] = GetString(data->getAsCString().str());
+            continue;
+        }
+
+        const auto copy = new llvm::GlobalVariable(*m_IRModule,
+                                                   variable->getValueType(),
+                                                   true,
+                                                   variable->getLinkage(),
+                                                   nullptr,
+                                                   variable->getName());
+        copy->setUnnamedAddr(variable->getUnnamedAddr());
+        copy->setAlignment(variable->getAlign());
+        map[variable] = copy;
+    }
+    for (const auto variable : carried)
+        if (!get_pooled_string(variable))
+            llvm::cast<llvm::GlobalVariable>(map[variable])->setInitializer(
+                llvm::MapValue(variable->getInitializer(), map));
+
+    for (const auto& [src, dest] : bodies)
+    {
+        for (size_t i = 0; i < src->arg_size(); ++i)
+            map[src->getArg(i)] = dest->getArg(i);
+
+        // the clone replaces the attributes of the declaration, which may carry hints of the front end
+        const auto declared = dest->getAttributes();
+
+        llvm::SmallVector<llvm::ReturnInst*, 8> returns;
+        llvm::CloneFunctionInto(dest, src, map, llvm::CloneFunctionChangeType::DifferentModule, returns);
+
+        strip_inferred(dest);
+        dest->addFnAttrs(llvm::AttrBuilder(*m_IRContext, declared.getFnAttrs()));
+        for (unsigned i = 0; i < dest->arg_size(); ++i)
+            dest->addParamAttrs(i, llvm::AttrBuilder(*m_IRContext, declared.getParamAttrs(i)));
+        InferAttributes(dest);
+    }
+
+    return true;
+}
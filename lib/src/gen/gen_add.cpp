@@ -19,7 +19,7 @@ Brewer::ValuePtr Brewer::Builder::GenAdd(Builder& builder,
     switch (type->GetID())
     {
     case Type_Integer:
-        result = builder.IRBuilder().CreateAdd(lhs->Get(), rhs->Get());
+        result = builder.IRBuilder().CreateAdd(lhs->Get(), rhs->Get(), "", builder.HasNUW(type), builder.HasNSW(type));
         break;
     case Type_Float:
         result = builder.IRBuilder().CreateFAdd(lhs->Get(), rhs->Get());
@@ -25,5 +25,5 @@ Brewer::ValuePtr Brewer::Builder::GenDec(Builder& builder, const ValuePtr& val,
         return {};
     }
 
-    return builder.GenBinaryFn("-")(builder, val, RValue::Direct(builder, type, one), result_type);
+    return builder.GetBinaryFn("-")(builder, val, RValue::Direct(builder, type, one), result_type);
 }
@@ -19,7 +19,9 @@ Brewer::ValuePtr Brewer::Builder::GenDiv(Builder& builder,
     switch (type->GetID())
     {
     case Type_Integer:
-        result = builder.IRBuilder().CreateSDiv(lhs->Get(), rhs->Get());
+        result = type->IsUnsigned()
+                     ? builder.IRBuilder().CreateUDiv(lhs->Get(), rhs->Get())
+                     : builder.IRBuilder().CreateSDiv(lhs->Get(), rhs->Get());
         break;
     case Type_Float:
         result = builder.IRBuilder().CreateFDiv(lhs->Get(), rhs->Get());
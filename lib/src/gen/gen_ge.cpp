@@ -17,7 +17,9 @@ Brewer::ValuePtr Brewer::Builder::GenGE(Builder& builder,
     switch (lhs->GetType()->GetID())
     {
     case Type_Integer:
-        result = builder.IRBuilder().CreateICmpSGE(lhs->Get(), rhs->Get());
+        result = lhs->GetType()->IsUnsigned()
+                     ? builder.IRBuilder().CreateICmpUGE(lhs->Get(), rhs->Get())
+                     : builder.IRBuilder().CreateICmpSGE(lhs->Get(), rhs->Get());
         break;
     case Type_Float:
         result = builder.IRBuilder().CreateFCmpOGE(lhs->Get(), rhs->Get());
@@ -17,7 +17,9 @@ Brewer::ValuePtr Brewer::Builder::GenGT(Builder& builder,
     switch (lhs->GetType()->GetID())
     {
     case Type_Integer:
-        result = builder.IRBuilder().CreateICmpSGT(lhs->Get(), rhs->Get());
+        result = lhs->GetType()->IsUnsigned()
+                     ? builder.IRBuilder().CreateICmpUGT(lhs->Get(), rhs->Get())
+                     : builder.IRBuilder().CreateICmpSGT(lhs->Get(), rhs->Get());
         break;
     case Type_Float:
         result = builder.IRBuilder().CreateFCmpOGT(lhs->Get(), rhs->Get());
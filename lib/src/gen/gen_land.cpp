@@ -1,10 +1,11 @@
+#include <Brewer/AST.hpp>
 #include <Brewer/Builder.hpp>
 #include <Brewer/Type.hpp>
 #include <Brewer/Value.hpp>
 
 Brewer::ValuePtr Brewer::Builder::GenLAnd(Builder& builder,
-                                          const ValuePtr& lhs,
-                                          const ValuePtr& rhs,
+                                          const Expression& lhs,
+                                          const Expression& rhs,
                                           TypePtr* result_type)
 {
     if (result_type)
@@ -13,9 +14,27 @@ Brewer::ValuePtr Brewer::Builder::GenLAnd(Builder& builder,
         return {};
     }
 
-    const auto l = builder.IRBuilder().CreateIsNotNull(lhs->Get());
-    const auto r = builder.IRBuilder().CreateIsNotNull(rhs->Get());
+    const auto lhs_value = lhs.GenIR(builder);
+    if (!lhs_value) return {};
+    const auto l = builder.IRBuilder().CreateIsNotNull(lhs_value->Get());
 
-    const auto result = builder.IRBuilder().CreateAnd(l, r);
+    // the right hand side only runs if the left hand side is true
+    const auto lhs_block = builder.IRBuilder().GetInsertBlock();
+    const auto function = lhs_block->getParent();
+    const auto rhs_block = llvm::BasicBlock::Create(builder.IRContext(), "land.rhs", function);
+    const auto end_block = llvm::BasicBlock::Create(builder.IRContext(), "land.end", function);
+    builder.IRBuilder().CreateCondBr(l, rhs_block, end_block);
+
+    builder.IRBuilder().SetInsertPoint(rhs_block);
+    const auto rhs_value = rhs.GenIR(builder);
+    if (!rhs_value) return {};
+    const auto r = builder.IRBuilder().CreateIsNotNull(rhs_value->Get());
+    const auto rhs_end = builder.IRBuilder().GetInsertBlock();
+    builder.IRBuilder().CreateBr(end_block);
+
+    builder.IRBuilder().SetInsertPoint(end_block);
+    const auto result = builder.IRBuilder().CreatePHI(builder.IRBuilder().getInt1Ty(), 2);
+    result->addIncoming(builder.IRBuilder().getFalse(), lhs_block);
+    result->addIncoming(r, rhs_end);
     return RValue::Direct(builder, Type::Get(builder.GetContext(), "i1"), result);
 }
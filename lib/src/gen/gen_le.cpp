@@ -17,7 +17,9 @@ Brewer::ValuePtr Brewer::Builder::GenLE(Builder& builder,
     switch (lhs->GetType()->GetID())
     {
     case Type_Integer:
-        result = builder.IRBuilder().CreateICmpSLE(lhs->Get(), rhs->Get());
+        result = lhs->GetType()->IsUnsigned()
+                     ? builder.IRBuilder().CreateICmpULE(lhs->Get(), rhs->Get())
+                     : builder.IRBuilder().CreateICmpSLE(lhs->Get(), rhs->Get());
         break;
     case Type_Float:
         result = builder.IRBuilder().CreateFCmpOLE(lhs->Get(), rhs->Get());
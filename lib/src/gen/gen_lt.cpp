@@ -17,7 +17,9 @@ Brewer::ValuePtr Brewer::Builder::GenLT(Builder& builder,
     switch (lhs->GetType()->GetID())
     {
     case Type_Integer:
-        result = builder.IRBuilder().CreateICmpSLT(lhs->Get(), rhs->Get());
+        result = lhs->GetType()->IsUnsigned()
+                     ? builder.IRBuilder().CreateICmpULT(lhs->Get(), rhs->Get())
+                     : builder.IRBuilder().CreateICmpSLT(lhs->Get(), rhs->Get());
         break;
     case Type_Float:
         result = builder.IRBuilder().CreateFCmpOLT(lhs->Get(), rhs->Get());
@@ -19,7 +19,7 @@ Brewer::ValuePtr Brewer::Builder::GenMul(Builder& builder,
     switch (type->GetID())
     {
     case Type_Integer:
-        result = builder.IRBuilder().CreateMul(lhs->Get(), rhs->Get());
+        result = builder.IRBuilder().CreateMul(lhs->Get(), rhs->Get(), "", builder.HasNUW(type), builder.HasNSW(type));
         break;
     case Type_Float:
         result = builder.IRBuilder().CreateFMul(lhs->Get(), rhs->Get());
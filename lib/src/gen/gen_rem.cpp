@@ -19,7 +19,9 @@ Brewer::ValuePtr Brewer::Builder::GenRem(Builder& builder,
     switch (type->GetID())
     {
     case Type_Integer:
-        result = builder.IRBuilder().CreateSRem(lhs->Get(), rhs->Get());
+        result = type->IsUnsigned()
+                     ? builder.IRBuilder().CreateURem(lhs->Get(), rhs->Get())
+                     : builder.IRBuilder().CreateSRem(lhs->Get(), rhs->Get());
         break;
     case Type_Float:
         result = builder.IRBuilder().CreateFRem(lhs->Get(), rhs->Get());
@@ -19,7 +19,7 @@ Brewer::ValuePtr Brewer::Builder::GenShl(Builder& builder,
     switch (type->GetID())
     {
     case Type_Integer:
-        result = builder.IRBuilder().CreateShl(lhs->Get(), rhs->Get());
+        result = builder.IRBuilder().CreateShl(lhs->Get(), rhs->Get(), "", builder.HasNUW(type), builder.HasNSW(type));
         break;
     default:
         return {};
@@ -19,7 +19,7 @@ Brewer::ValuePtr Brewer::Builder::GenSub(Builder& builder,
     switch (type->GetID())
     {
     case Type_Integer:
-        result = builder.IRBuilder().CreateSub(lhs->Get(), rhs->Get());
+        result = builder.IRBuilder().CreateSub(lhs->Get(), rhs->Get(), "", builder.HasNUW(type), builder.HasNSW(type));
         break;
     case Type_Float:
         result = builder.IRBuilder().CreateFSub(lhs->Get(), rhs->Get());
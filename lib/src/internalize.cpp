@@ -0,0 +1,139 @@
+#include <set>
+#include <Brewer/Builder.hpp>
+#include <Brewer/Value.hpp>
+#include <llvm/IR/Instructions.h>
+
+using Marker = std::function<void(const llvm::Value*)>;
+
+// global values are found through the constants that refer to them, e.g. a getelementptr into a string
+static void mark_operand(const llvm::Value* operand, std::set<const llvm::Constant*>& visited, const Marker& mark)
+{
+    if (const auto value = llvm::dyn_cast<llvm::GlobalValue>(operand))
+    {
+        mark(value);
+        return;
+    }
+    const auto constant = llvm::dyn_cast<llvm::Constant>(operand);
+    if (!constant || !visited.insert(constant).second) return;
+    for (const auto& op : constant->operands())
+        mark_operand(op, visited, mark);
+}
+
+// everything that is not local is visible to the outside and keeps whatever it refers to alive
+static std::set<llvm::GlobalValue*> find_dead(llvm::Module& module, const std::set<llvm::GlobalValue*>& roots)
+{
+    std::set<const llvm::GlobalValue*> live;
+    std::vector<const llvm::GlobalValue*> worklist;
+    std::set<const llvm::Constant*> visited;
+
+    const Marker mark = [&](const llvm::Value* value)
+    {
+        const auto global = llvm::cast<llvm::GlobalValue>(value);
+        if (live.insert(global).second) worklist.push_back(global);
+    };
+
+    for (auto& value : module.global_values())
+        if (!value.hasLocalLinkage() || roots.count(&value)) mark(&value);
+
+    while (!worklist.empty())
+    {
+        const auto value = worklist.back();
+        worklist.pop_back();
+
+        if (const auto function = llvm::dyn_cast<llvm::Function>(value))
+        {
+            for (const auto& block : *function)
+                for (const auto& inst : block)
+                    for (const auto& op : inst.operands())
+                        mark_operand(op, visited, mark);
+        }
+        else if (const auto variable = llvm::dyn_cast<llvm::GlobalVariable>(value))
+        {
+            if (variable->hasInitializer()) mark_operand(variable->getInitializer(), visited, mark);
+        }
+        else if (const auto alias = llvm::dyn_cast<llvm::GlobalAlias>(value))
+        {
+            mark_operand(alias->getAliasee(), visited, mark);
+        }
+    }
+
+    std::set<llvm::GlobalValue*> dead;
+    for (auto& value : module.global_values())
+        if (!live.count(&value)) dead.insert(&value);
+    return dead;
+}
+
+void Brewer::Builder::Export(const std::string& name)
+{
+    m_Exports.insert(name);
+}
+
+bool Brewer::Builder::IsExported(const std::string& name) const
+{
+    return m_Exports.count(name);
+}
+
+void Brewer::Builder::Internalize()
+{
+    if (m_Exports.empty()) return;
+    JoinStreamed();
+
+    for (auto& function : *m_IRModule)
+        if (!function.isDeclaration() && function.hasExternalLinkage() && !IsExported(function.getName().str()))
+            function.setLinkage(llvm::GlobalValue::InternalLinkage);
+
+    const auto dead = find_dead(*m_IRModule, {m_GlobalCtor, m_GlobalDtor});
+    for (const auto value : dead)
+        value->dropAllReferences();
+    for (const auto value : dead)
+        value->eraseFromParent();
+
+    // nothing may refer to the removed values any longer
+    for (auto& [type, functions] : m_Functions)
+        for (auto it = functions.begin(); it != functions.end();)
+        {
+            const auto value = RValue::From(it->second);
+            if (value && dead.count(llvm::dyn_cast_or_null<llvm::GlobalValue>(value->Get())))
+                it = functions.erase(it);
+            else ++it;
+        }
+    for (auto it = m_IntrinsicFunctions.begin(); it != m_IntrinsicFunctions.end();)
+    {
+        const auto value = RValue::From(it->second);
+        if (value && dead.count(llvm::dyn_cast_or_null<llvm::GlobalValue>(value->Get())))
+            it = m_IntrinsicFunctions.erase(it);
+        else ++it;
+    }
+    for (auto it = m_Strings.begin(); it != m_Strings.end();)
+    {
+        if (dead.count(it->second)) it = m_Strings.erase(it);
+        else ++it;
+    }
+    for (auto it = m_StreamedFunctions.begin(); it != m_StreamedFunctions.end();)
+    {
+        if (dead.count(*it)) it = m_StreamedFunctions.erase(it);
+        else ++it;
+    }
+    for (auto it = m_FunctionFastMathFlags.begin(); it != m_FunctionFastMathFlags.end();)
+    {
+        if (dead.count(it->first)) it = m_FunctionFastMathFlags.erase(it);
+        else ++it;
+    }
+
+    // only direct calls reach an internal function whose address is never taken, so all of them can agree on
+    // the faster convention
+    for (auto& function : *m_IRModule)
+    {
+        if (function.isDeclaration() || !function.hasLocalLinkage() || function.hasAddressTaken()) continue;
+        function.setCallingConv(llvm::CallingConv::Fast);
+        for (const auto user : function.users())
+            if (const auto call = llvm::dyn_cast<llvm::CallBase>(user))
+                call->setCallingConv(llvm::CallingConv::Fast);
+    }
+
+    // musttail calls marked while every function still used the c convention no longer match where only one
+    // side became fastcc, and calls between functions that now share fastcc may become musttail
+    if (m_TailCalls == TailCallMode_MustTail)
+        for (auto& function : *m_IRModule)
+            MarkTailCalls(&function);
+}
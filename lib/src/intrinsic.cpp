@@ -0,0 +1,118 @@
+#include <Brewer/Builder.hpp>
+#include <Brewer/Context.hpp>
+#include <Brewer/Type.hpp>
+#include <Brewer/Value.hpp>
+#include <llvm/IR/Constants.h>
+
+static void register_intrinsics(Brewer::Builder& builder,
+                                std::map<std::string, Brewer::IntrinsicMapping>& intrinsics)
+{
+    auto& context = builder.GetContext();
+    auto& ir = builder.IRBuilder();
+
+    const auto get = [&](const Brewer::TypePtr& result, const std::vector<Brewer::TypePtr>& params)
+    {
+        return Brewer::FunctionType::Get(Brewer::FuncMode_Normal, {}, result, params, false);
+    };
+
+    // registrations made before the first lookup take precedence
+    const auto add = [&](const std::string& name,
+                         const Brewer::FunctionTypePtr& type,
+                         const llvm::Intrinsic::ID id,
+                         std::vector<llvm::Constant*> extra = {})
+    {
+        intrinsics.emplace(name, Brewer::IntrinsicMapping{type, id, std::move(extra)});
+    };
+
+    for (const auto& [suffix, type] : {
+             std::pair{std::string(), context.GetFloat64Ty()},
+             std::pair{std::string("f"), context.GetFloat32Ty()},
+         })
+    {
+        add("sqrt" + suffix, get(type, {type}), llvm::Intrinsic::sqrt);
+        add("fabs" + suffix, get(type, {type}), llvm::Intrinsic::fabs);
+        add("floor" + suffix, get(type, {type}), llvm::Intrinsic::floor);
+        add("fma" + suffix, get(type, {type, type, type}), llvm::Intrinsic::fma);
+        add("copysign" + suffix, get(type, {type, type}), llvm::Intrinsic::copysign);
+        add("fmin" + suffix, get(type, {type, type}), llvm::Intrinsic::minnum);
+        add("fmax" + suffix, get(type, {type, type}), llvm::Intrinsic::maxnum);
+    }
+
+    for (const auto bits : {16, 32, 64})
+    {
+        const auto suffix = bits == 64 ? std::string() : std::to_string(bits);
+        const auto type = context.GetIntNTy(bits);
+        add("ctpop" + suffix, get(type, {type}), llvm::Intrinsic::ctpop);
+        add("ctlz" + suffix, get(type, {type}), llvm::Intrinsic::ctlz, {ir.getFalse()});
+        add("bswap" + suffix, get(type, {type}), llvm::Intrinsic::bswap);
+    }
+
+    const auto void_ty = context.GetVoidTy();
+    const auto ptr_ty = context.GetInt8PtrTy();
+    const auto i8_ty = context.GetInt8Ty();
+    const auto i64_ty = context.GetInt64Ty();
+    add("memcpy", get(void_ty, {ptr_ty, ptr_ty, i64_ty}), llvm::Intrinsic::memcpy, {ir.getFalse()});
+    add("memset", get(void_ty, {ptr_ty, i8_ty, i64_ty}), llvm::Intrinsic::memset, {ir.getFalse()});
+    // read, high locality, data cache
+    add("prefetch",
+        get(void_ty, {ptr_ty}),
+        llvm::Intrinsic::prefetch,
+        {ir.getInt32(0), ir.getInt32(3), ir.getInt32(1)});
+    add("expect", get(i64_ty, {i64_ty, i64_ty}), llvm::Intrinsic::expect);
+}
+
+void Brewer::Builder::GenIntrinsic(const std::string& name, const IntrinsicMapping& mapping)
+{
+    m_Intrinsics[name] = mapping;
+
+    // the function a lookup already returned goes too, or calls through it would miss the new extra arguments
+    const auto it = m_IntrinsicFunctions.find(name);
+    if (it == m_IntrinsicFunctions.end()) return;
+    auto& functions = m_Functions[{}];
+    if (const auto function = functions.find(name); function != functions.end() && function->second == it->second)
+        functions.erase(function);
+    m_IntrinsicFunctions.erase(it);
+}
+
+Brewer::ValuePtr Brewer::Builder::GetIntrinsic(const std::string& name, const FunctionTypePtr& type)
+{
+    if (!m_IntrinsicsRegistered)
+    {
+        register_intrinsics(*this, m_Intrinsics);
+        m_IntrinsicsRegistered = true;
+    }
+
+    const auto it = m_Intrinsics.find(name);
+    if (it == m_Intrinsics.end()) return {};
+
+    const auto& [Type, ID, Extra] = it->second;
+    if (type && type != Type) return {};
+
+    auto& function = m_IntrinsicFunctions[name];
+    if (function) return function;
+
+    // the intrinsic's own signature has the extra arguments, and its overloaded types are taken from it
+    const auto fn_ty = Type->GenIR(*this);
+    std::vector<llvm::Type*> params(fn_ty->param_begin(), fn_ty->param_end());
+    for (const auto constant : Extra)
+        params.push_back(constant->getType());
+    const auto intrinsic_ty = llvm::FunctionType::get(fn_ty->getReturnType(), params, false);
+
+    llvm::SmallVector<llvm::Intrinsic::IITDescriptor, 8> table;
+    llvm::Intrinsic::getIntrinsicInfoTableEntries(ID, table);
+    llvm::ArrayRef<llvm::Intrinsic::IITDescriptor> descriptors = table;
+    llvm::SmallVector<llvm::Type*, 4> overloads;
+    if (llvm::Intrinsic::matchIntrinsicSignature(intrinsic_ty, descriptors, overloads)
+        != llvm::Intrinsic::MatchIntrinsicTypes_Match)
+        return {};
+
+    const auto declaration = llvm::Intrinsic::getDeclaration(m_IRModule.get(), ID, overloads);
+    return function = RValue::Direct(*this, PointerType::Get(Type), declaration);
+}
+
+llvm::ArrayRef<llvm::Constant*> Brewer::Builder::GetIntrinsicExtra(const ValuePtr& callee) const
+{
+    for (const auto& [name, function] : m_IntrinsicFunctions)
+        if (function == callee) return m_Intrinsics.at(name).Extra;
+    return {};
+}
@@ -0,0 +1,166 @@
+#include <iostream>
+#include <Brewer/Builder.hpp>
+#include <Brewer/JIT.hpp>
+#include <Brewer/Util.hpp>
+#include <llvm/ExecutionEngine/Orc/ExecutionUtils.h>
+#include <llvm/Support/TargetSelect.h>
+
+template <typename T>
+static T& use_object_cache(T& builder, Brewer::ObjectCache* cache)
+{
+    if (!cache) return builder;
+
+    return builder.setCompileFunctionCreator(
+        [cache](llvm::orc::JITTargetMachineBuilder jtmb)
+            -> llvm::Expected<std::unique_ptr<llvm::orc::IRCompileLayer::IRCompiler>>
+        {
+            auto machine = jtmb.createTargetMachine();
+            if (!machine) return machine.takeError();
+
+            cache->SetTarget((*machine)->getTargetTriple().str()
+                + ';' + (*machine)->getTargetCPU().str()
+                + ';' + (*machine)->getTargetFeatureString().str()
+                + ';' + std::to_string(static_cast<int>((*machine)->getOptLevel()))
+                + ';' + std::to_string((*machine)->Options.AllowFPOpFusion));
+
+            return std::make_unique<llvm::orc::TMOwningSimpleCompiler>(std::move(*machine), cache);
+        });
+}
+
+static llvm::Expected<std::unique_ptr<llvm::orc::LLJIT>> create_jit(const bool lazy,
+                                                                    const llvm::FPOpFusion::FPOpFusionMode fp_contract,
+                                                                    Brewer::ObjectCache* cache)
+{
+    auto machine = llvm::orc::JITTargetMachineBuilder::detectHost();
+    if (!machine) return machine.takeError();
+    machine->getOptions().AllowFPOpFusion = fp_contract;
+
+    if (!lazy)
+    {
+        llvm::orc::LLJITBuilder builder;
+        builder.setJITTargetMachineBuilder(std::move(*machine));
+        return use_object_cache(builder, cache).create();
+    }
+
+    llvm::orc::LLLazyJITBuilder builder;
+    builder.setJITTargetMachineBuilder(std::move(*machine));
+    auto jit = use_object_cache(builder, cache).create();
+    if (!jit) return jit.takeError();
+
+    // every function becomes its own partition behind a stub, compiled on its first call
+    (*jit)->setPartitionFunction(llvm::orc::CompileOnDemandLayer::compileRequested);
+    return std::move(*jit);
+}
+
+std::unique_ptr<Brewer::JIT> Brewer::JIT::Create(const bool lazy,
+                                                const std::shared_ptr<Cache>& cache,
+                                                const llvm::FPOpFusion::FPOpFusionMode fp_contract)
+{
+    llvm::InitializeNativeTarget();
+    llvm::InitializeNativeTargetAsmPrinter();
+
+    std::unique_ptr<ObjectCache> object_cache;
+    if (cache) object_cache = std::make_unique<ObjectCache>(cache);
+
+    auto jit = create_jit(lazy, fp_contract, object_cache.get());
+    if (!jit)
+        return Err()
+            << "failed to create jit: " << llvm::toString(jit.takeError())
+            << std::endl
+            << ErrMark<std::unique_ptr<JIT>>();
+
+    // extern declarations resolve against the symbols of the host process
+    auto& main = (*jit)->getMainJITDylib();
+    auto generator = llvm::orc::DynamicLibrarySearchGenerator::GetForCurrentProcess(
+        (*jit)->getDataLayout().getGlobalPrefix());
+    if (!generator)
+        return Err()
+            << "failed to create process symbol generator: " << llvm::toString(generator.takeError())
+            << std::endl
+            << ErrMark<std::unique_ptr<JIT>>();
+    main.addGenerator(std::move(*generator));
+
+    return std::make_unique<JIT>(std::move(*jit), lazy, std::move(object_cache));
+}
+
+Brewer::JIT::JIT(std::unique_ptr<llvm::orc::LLJIT> jit, const bool lazy, std::unique_ptr<ObjectCache> object_cache)
+    : m_ObjectCache(std::move(object_cache)), m_JIT(std::move(jit)), m_Lazy(lazy)
+{
+    // the transform layer sits right in front of the compiler, so everything passing it gets compiled
+    m_JIT->getIRTransformLayer().setTransform(
+        [this](llvm::orc::ThreadSafeModule module, llvm::orc::MaterializationResponsibility&)
+        {
+            module.withModuleDo([this](const llvm::Module& m)
+            {
+                ++m_CompiledModules;
+                for (const auto& function : m)
+                    if (!function.isDeclaration()) ++m_CompiledFunctions;
+            });
+            return llvm::Expected<llvm::orc::ThreadSafeModule>(std::move(module));
+        });
+}
+
+Brewer::JIT::~JIT()
+{
+    if (!m_Initialized) return;
+
+    // runs brewer.global_dtor and everything else registered in llvm.global_dtors
+    if (auto error = m_JIT->deinitialize(m_JIT->getMainJITDylib()))
+        Err() << "failed to deinitialize jit: " << llvm::toString(std::move(error)) << std::endl;
+}
+
+llvm::orc::LLJIT& Brewer::JIT::GetLLJIT() const
+{
+    return *m_JIT;
+}
+
+bool Brewer::JIT::IsLazy() const
+{
+    return m_Lazy;
+}
+
+Brewer::JITStatistics Brewer::JIT::GetStatistics() const
+{
+    return {m_CompiledModules, m_CompiledFunctions};
+}
+
+Brewer::ObjectCache* Brewer::JIT::GetObjectCache() const
+{
+    return m_ObjectCache.get();
+}
+
+bool Brewer::JIT::Add(Builder& builder)
+{
+    auto error = m_Lazy
+                     ? static_cast<llvm::orc::LLLazyJIT&>(*m_JIT).addLazyIRModule(builder.TakeModule())
+                     : m_JIT->addIRModule(builder.TakeModule());
+    if (error)
+        return Err()
+            << "failed to add module to jit: " << llvm::toString(std::move(error))
+            << std::endl
+            << ErrMark<bool>();
+    return true;
+}
+
+bool Brewer::JIT::Initialize()
+{
+    // runs brewer.global_ctor and everything else registered in llvm.global_ctors
+    if (auto error = m_JIT->initialize(m_JIT->getMainJITDylib()))
+        return Err()
+            << "failed to initialize jit: " << llvm::toString(std::move(error))
+            << std::endl
+            << ErrMark<bool>();
+    m_Initialized = true;
+    return true;
+}
+
+void* Brewer::JIT::Lookup(const std::string& name) const
+{
+    auto address = m_JIT->lookup(name);
+    if (!address)
+        return Err()
+            << "failed to lookup symbol '" << name << "': " << llvm::toString(address.takeError())
+            << std::endl
+            << ErrMark<void*>();
+    return address->toPtr<void*>();
+}
@@ -0,0 +1,144 @@
+#include <algorithm>
+#include <cstdlib>
+#include <new>
+#include <Brewer/Memory.hpp>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+static thread_local Brewer::PhaseAllocations allocations{};
+
+bool Brewer::IsCountingAllocations()
+{
+#ifdef BREWER_COUNT_ALLOCATIONS
+    return true;
+#else
+    return false;
+#endif
+}
+
+void Brewer::CountAllocation(const size_t bytes)
+{
+    auto& [Count, Bytes] = allocations[PhaseScope::GetCurrentPhase()];
+    ++Count;
+    Bytes += bytes;
+}
+
+Brewer::PhaseAllocations Brewer::GetThreadAllocations()
+{
+    return allocations;
+}
+
+size_t Brewer::GetPeakRSS()
+{
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) return 0;
+    return counters.PeakWorkingSetSize;
+#else
+    rusage usage{};
+    if (getrusage(RUSAGE_SELF, &usage)) return 0;
+#ifdef __APPLE__
+    return usage.ru_maxrss;
+#else
+    return usage.ru_maxrss * 1024;
+#endif
+#endif
+}
+
+void Brewer::MemoryStatistics::Merge(const MemoryStatistics& other)
+{
+    Builds += other.Builds;
+    PeakRSS = std::max(PeakRSS, other.PeakRSS);
+    for (size_t i = 0; i < Allocations.size(); ++i)
+    {
+        Allocations[i].Count += other.Allocations[i].Count;
+        Allocations[i].Bytes += other.Allocations[i].Bytes;
+    }
+    Types += other.Types;
+    Functions += other.Functions;
+    BasicBlocks += other.BasicBlocks;
+    Instructions += other.Instructions;
+}
+
+void Brewer::MemoryStatistics::DumpJSON(std::ostream& stream) const
+{
+    stream
+        << "{\"builds\":" << Builds
+        << ",\"peak_rss\":" << PeakRSS
+        << ",\"allocations_counted\":" << (IsCountingAllocations() ? "true" : "false")
+        << ",\"allocations\":{";
+    for (size_t i = 0; i < Allocations.size(); ++i)
+    {
+        if (i > 0) stream << ',';
+        const auto name = i < Phase_Count ? Timing::GetPhaseName(static_cast<Phase>(i)) : "other";
+        stream << '"' << name << "\":{\"count\":" << Allocations[i].Count << ",\"bytes\":" << Allocations[i].Bytes << '}';
+    }
+    stream
+        << "},\"types\":" << Types
+        << ",\"functions\":" << Functions
+        << ",\"basic_blocks\":" << BasicBlocks
+        << ",\"instructions\":" << Instructions
+        << '}';
+}
+
+#ifdef BREWER_COUNT_ALLOCATIONS
+
+void* operator new(const std::size_t size)
+{
+    Brewer::CountAllocation(size);
+    if (const auto ptr = std::malloc(size ? size : 1)) return ptr;
+    throw std::bad_alloc();
+}
+
+void* operator new[](const std::size_t size)
+{
+    return operator new(size);
+}
+
+void* operator new(const std::size_t size, const std::nothrow_t&) noexcept
+{
+    Brewer::CountAllocation(size);
+    return std::malloc(size ? size : 1);
+}
+
+void* operator new[](const std::size_t size, const std::nothrow_t&) noexcept
+{
+    return operator new(size, std::nothrow);
+}
+
+void operator delete(void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, const std::nothrow_t&) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept
+{
+    std::free(ptr);
+}
+
+#endif
@@ -113,6 +113,7 @@ Brewer::Token Brewer::Parser::NextToken()
         State_Oct,
         State_Dec,
         State_Hex,
+        State_Suffix,
         State_Char,
         State_String,
         State_Operator,
@@ -123,6 +124,7 @@ Brewer::Token Brewer::Parser::NextToken()
 
     auto state = State_Normal;
     bool isfloat;
+    TokenType number_type;
     std::string value;
     SourceLocation loc;
 
@@ -258,19 +260,41 @@ Brewer::Token Brewer::Parser::NextToken()
                 value += static_cast<char>(m_CC);
                 break;
             }
+            if (m_CC == 'i' || m_CC == 'u' || m_CC == 'f')
+            {
+                state = State_Suffix;
+                number_type = TokenType_Dec;
+                value += '0';
+                value += static_cast<char>(m_CC);
+                break;
+            }
             return {loc, TokenType_Dec, "0"};
 
         case State_Bin:
-            if (m_CC == '0' || m_CC == '1' || m_CC == 'u')
+            if (m_CC == '0' || m_CC == '1')
             {
                 value += static_cast<char>(m_CC);
                 break;
             }
+            if (m_CC == 'i' || m_CC == 'u')
+            {
+                state = State_Suffix;
+                number_type = TokenType_Bin;
+                value += static_cast<char>(m_CC);
+                break;
+            }
             return {loc, TokenType_Bin, value};
 
         case State_Oct:
-            if (is_oct_digit(m_CC) || m_CC == 'u')
+            if (is_oct_digit(m_CC))
+            {
+                value += static_cast<char>(m_CC);
+                break;
+            }
+            if (m_CC == 'i' || m_CC == 'u')
             {
+                state = State_Suffix;
+                number_type = TokenType_Oct;
                 value += static_cast<char>(m_CC);
                 break;
             }
@@ -283,21 +307,43 @@ Brewer::Token Brewer::Parser::NextToken()
                 value += static_cast<char>(m_CC);
                 break;
             }
-            if (isdigit(m_CC) || m_CC == 'u')
+            if (isdigit(m_CC))
             {
                 value += static_cast<char>(m_CC);
                 break;
             }
+            if (m_CC == 'i' || m_CC == 'u' || m_CC == 'f')
+            {
+                state = State_Suffix;
+                number_type = isfloat ? TokenType_Float : TokenType_Dec;
+                value += static_cast<char>(m_CC);
+                break;
+            }
             return {loc, isfloat ? TokenType_Float : TokenType_Dec, value};
 
         case State_Hex:
-            if (isxdigit(m_CC) || m_CC == 'u')
+            if (isxdigit(m_CC))
             {
                 value += static_cast<char>(m_CC);
                 break;
             }
+            if (m_CC == 'i' || m_CC == 'u')
+            {
+                state = State_Suffix;
+                number_type = TokenType_Hex;
+                value += static_cast<char>(m_CC);
+                break;
+            }
             return {loc, TokenType_Hex, value};
 
+        case State_Suffix:
+            if (isalnum(m_CC))
+            {
+                value += static_cast<char>(m_CC);
+                break;
+            }
+            return {loc, number_type, value};
+
         case State_Name:
             if (isalnum(m_CC) || m_CC == '_')
             {
@@ -0,0 +1,50 @@
+#include <Brewer/ObjectCache.hpp>
+#include <llvm/Bitcode/BitcodeWriter.h>
+#include <llvm/IR/Module.h>
+
+Brewer::ObjectCache::ObjectCache(std::shared_ptr<Cache> cache)
+    : m_Cache(std::move(cache))
+{
+}
+
+Brewer::Cache& Brewer::ObjectCache::GetCache() const
+{
+    return *m_Cache;
+}
+
+void Brewer::ObjectCache::SetTarget(const std::string& target)
+{
+    m_Target = target;
+}
+
+void Brewer::ObjectCache::notifyObjectCompiled(const llvm::Module* module, const llvm::MemoryBufferRef object)
+{
+    std::string key;
+    {
+        const std::lock_guard lock(m_Mutex);
+        const auto it = m_Keys.find(module);
+        if (it == m_Keys.end()) return;
+        key = std::move(it->second);
+        m_Keys.erase(it);
+    }
+
+    m_Cache->Put(key, object.getBuffer());
+}
+
+std::unique_ptr<llvm::MemoryBuffer> Brewer::ObjectCache::getObject(const llvm::Module* module)
+{
+    // the key has to be computed before codegen, because the codegen passes modify the module
+    llvm::SmallVector<char, 0> bitcode;
+    {
+        llvm::raw_svector_ostream stream(bitcode);
+        llvm::WriteBitcodeToFile(*module, stream);
+    }
+
+    auto key = Cache::Hash({"obj", m_Target, llvm::StringRef(bitcode.data(), bitcode.size())}) + ".o";
+    if (auto object = m_Cache->Get(key))
+        return object;
+
+    const std::lock_guard lock(m_Mutex);
+    m_Keys[module] = std::move(key);
+    return {};
+}
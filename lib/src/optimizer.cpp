@@ -0,0 +1,111 @@
+#include <optional>
+#include <set>
+#include <Brewer/Optimizer.hpp>
+#include <llvm/Analysis/InlineCost.h>
+#include <llvm/IR/ValueHandle.h>
+#include <llvm/Transforms/IPO/ModuleInliner.h>
+#include <llvm/Support/TimeProfiler.h>
+
+static llvm::OptimizationLevel get_level(const unsigned level)
+{
+    switch (level)
+    {
+    case 0: return llvm::OptimizationLevel::O0;
+    case 1: return llvm::OptimizationLevel::O1;
+    case 2: return llvm::OptimizationLevel::O2;
+    default: return llvm::OptimizationLevel::O3;
+    }
+}
+
+Brewer::Optimizer::Optimizer(const unsigned level, llvm::TargetMachine* machine)
+    : m_Level(level), m_PassBuilder(machine, llvm::PipelineTuningOptions(), std::nullopt, &m_PIC)
+{
+    // every pass shows up in the time trace, if one is recorded
+    if (llvm::timeTraceProfilerEnabled()) m_TimeProfiling.registerCallbacks(m_PIC);
+
+    m_PassBuilder.registerModuleAnalyses(m_MAM);
+    m_PassBuilder.registerCGSCCAnalyses(m_CGAM);
+    m_PassBuilder.registerFunctionAnalyses(m_FAM);
+    m_PassBuilder.registerLoopAnalyses(m_LAM);
+    m_PassBuilder.crossRegisterProxies(m_LAM, m_FAM, m_CGAM, m_MAM);
+
+    if (m_Level)
+        m_FPM = m_PassBuilder.buildFunctionSimplificationPipeline(get_level(m_Level),
+                                                                  llvm::ThinOrFullLTOPhase::None);
+}
+
+unsigned Brewer::Optimizer::GetLevel() const
+{
+    return m_Level;
+}
+
+void Brewer::Optimizer::Run(llvm::Function& function)
+{
+    if (!m_Level || function.isDeclaration()) return;
+
+    llvm::TimeTraceScope trace("OptimizeFunction", function.getName());
+    m_FPM.run(function, m_FAM);
+
+    // the analyses are keyed by the function, which may be gone or changed by the next run
+    m_FAM.clear(function, function.getName());
+}
+
+static void clear(llvm::LoopAnalysisManager& lam,
+                  llvm::FunctionAnalysisManager& fam,
+                  llvm::CGSCCAnalysisManager& cgam,
+                  llvm::ModuleAnalysisManager& mam)
+{
+    lam.clear();
+    fam.clear();
+    cgam.clear();
+    mam.clear();
+}
+
+void Brewer::Optimizer::RunSimplified(llvm::Module& module)
+{
+    if (!m_Level) return;
+
+    clear(m_LAM, m_FAM, m_CGAM, m_MAM);
+
+    llvm::TimeTraceScope trace("OptimizeModule", module.getModuleIdentifier());
+
+    // only functions that call a definition can be inlined into, so only they are simplified once more. the
+    // inliner may delete functions that became dead, which the handles notice
+    std::vector<llvm::WeakVH> callers;
+    for (auto& function : module)
+    {
+        if (function.isDeclaration()) continue;
+        for (const auto user : function.users())
+            if (const auto call = llvm::dyn_cast<llvm::CallBase>(user); call && call->getCalledFunction() == &function)
+                callers.emplace_back(call->getFunction());
+    }
+
+    llvm::ModulePassManager inliner;
+    inliner.addPass(llvm::ModuleInlinerPass(llvm::getInlineParams(m_Level, 0)));
+    inliner.run(module, m_MAM);
+    clear(m_LAM, m_FAM, m_CGAM, m_MAM);
+
+    std::set<llvm::Function*> simplified;
+    for (const auto& caller : callers)
+    {
+        const auto function = llvm::cast_or_null<llvm::Function>(caller);
+        if (function && simplified.insert(function).second) Run(*function);
+    }
+    clear(m_LAM, m_FAM, m_CGAM, m_MAM);
+
+    auto pass = m_PassBuilder.buildModuleOptimizationPipeline(get_level(m_Level), llvm::ThinOrFullLTOPhase::None);
+    pass.run(module, m_MAM);
+}
+
+void Brewer::Optimizer::Run(llvm::Module& module)
+{
+    // whatever happened to the module since the last run may have outdated the cached analyses
+    clear(m_LAM, m_FAM, m_CGAM, m_MAM);
+
+    llvm::TimeTraceScope trace("OptimizeModule", module.getModuleIdentifier());
+
+    auto pass = m_Level
+                    ? m_PassBuilder.buildPerModuleDefaultPipeline(get_level(m_Level))
+                    : m_PassBuilder.buildO0DefaultPipeline(llvm::OptimizationLevel::O0);
+    pass.run(module, m_MAM);
+}
@@ -0,0 +1,283 @@
+#include <cmath>
+#include <limits>
+#include <Brewer/AST.hpp>
+#include <Brewer/Builder.hpp>
+#include <Brewer/Context.hpp>
+#include <Brewer/Parser.hpp>
+#include <Brewer/Type.hpp>
+
+struct Constant
+{
+    Brewer::TypePtr Type;
+    unsigned long long Int = 0;
+    double Float = 0.0;
+    bool Suffixed = false;
+};
+
+// integer constants are kept zero extended to the width of their type
+static unsigned long long mask(const unsigned long long value, const size_t bits)
+{
+    if (bits >= 64) return value;
+    return value & ((1ull << bits) - 1);
+}
+
+static long long sext(const unsigned long long value, const size_t bits)
+{
+    if (bits >= 64) return static_cast<long long>(value);
+    return static_cast<long long>(value << (64 - bits)) >> (64 - bits);
+}
+
+// f16 has no host type to round through, so it is left to the ir builder
+static bool is_foldable(const Brewer::TypePtr& type)
+{
+    return type && (type->IsInt() || type->IsFloat32() || type->IsFloat64());
+}
+
+static double round_to(const double value, const Brewer::TypePtr& type)
+{
+    if (type->IsFloat32()) return static_cast<float>(value);
+    return value;
+}
+
+static bool get_constant(const Brewer::Expression* expr, Constant& constant)
+{
+    if (const auto i = dynamic_cast<const Brewer::ConstIntExpression*>(expr))
+    {
+        if (!i->Type || !i->Type->IsInt()) return false;
+        constant.Type = i->Type;
+        constant.Int = mask(i->Value, i->Type->GetSize());
+        constant.Suffixed = i->Suffixed;
+        return true;
+    }
+    if (const auto c = dynamic_cast<const Brewer::ConstCharExpression*>(expr))
+    {
+        if (!c->Type || !c->Type->IsInt()) return false;
+        constant.Type = c->Type;
+        constant.Int = mask(static_cast<unsigned char>(c->Value), c->Type->GetSize());
+        constant.Suffixed = true;
+        return true;
+    }
+    if (const auto f = dynamic_cast<const Brewer::ConstFloatExpression*>(expr))
+    {
+        if (!is_foldable(f->Type)) return false;
+        constant.Type = f->Type;
+        constant.Float = round_to(f->Value, f->Type);
+        constant.Suffixed = f->Suffixed;
+        return true;
+    }
+    return false;
+}
+
+// same conversions as Builder::GenCast
+static bool cast(Constant& constant, const Brewer::TypePtr& dst)
+{
+    if (constant.Type == dst) return true;
+    if (!is_foldable(dst)) return false;
+
+    const auto& src = constant.Type;
+    if (src->IsUnsigned())
+    {
+        if (dst->IsInt()) constant.Int = mask(constant.Int, dst->GetSize());
+        else constant.Float = round_to(static_cast<double>(constant.Int), dst);
+    }
+    else if (src->IsInt())
+    {
+        const auto value = sext(constant.Int, src->GetSize());
+        if (dst->IsInt()) constant.Int = mask(static_cast<unsigned long long>(value), dst->GetSize());
+        else constant.Float = round_to(static_cast<double>(value), dst);
+    }
+    else
+    {
+        if (dst->IsInt())
+        {
+            // out of range conversions are poison, so they are not folded
+            const auto value = std::trunc(constant.Float);
+            const auto bits = dst->GetSize();
+            if (dst->IsUnsigned())
+            {
+                if (!(value >= 0.0 && value < std::ldexp(1.0, static_cast<int>(bits)))) return false;
+                constant.Int = static_cast<unsigned long long>(value);
+            }
+            else
+            {
+                const auto limit = std::ldexp(1.0, static_cast<int>(bits) - 1);
+                if (bits > 1 && !(value >= -limit && value < limit)) return false;
+                if (bits == 1 && !(value == 0.0 || value == -1.0)) return false;
+                constant.Int = mask(static_cast<unsigned long long>(static_cast<long long>(value)), bits);
+            }
+        }
+        else constant.Float = round_to(constant.Float, dst);
+    }
+
+    constant.Type = dst;
+    return true;
+}
+
+// the result keeps adapting to its context only if none of its operands had a suffix
+static Brewer::ExprPtr make_literal(const Brewer::SourceLocation& loc, const Constant& constant)
+{
+    if (constant.Type->IsInt())
+    {
+        auto expr = std::make_unique<Brewer::ConstIntExpression>(loc, constant.Type, constant.Int);
+        expr->Suffixed = constant.Suffixed;
+        return expr;
+    }
+
+    auto expr = std::make_unique<Brewer::ConstFloatExpression>(loc, constant.Type, constant.Float);
+    expr->Suffixed = constant.Suffixed;
+    return expr;
+}
+
+// conditions never adapt, an i1 true widens to -1 and not to 1
+static Brewer::ExprPtr make_bool(const Brewer::SourceLocation& loc, Brewer::Context& context, const bool value)
+{
+    auto expr = std::make_unique<Brewer::ConstIntExpression>(loc, context.GetInt1Ty(), value ? 1 : 0);
+    expr->Suffixed = true;
+    return expr;
+}
+
+static Brewer::ExprPtr fold_int(const Brewer::SourceLocation& loc,
+                                Brewer::Context& context,
+                                const std::string& op,
+                                const Constant& lhs,
+                                const Constant& rhs)
+{
+    const auto bits = lhs.Type->GetSize();
+    const auto is_unsigned = lhs.Type->IsUnsigned();
+    const auto l = lhs.Int;
+    const auto r = rhs.Int;
+    const auto sl = sext(l, bits);
+    const auto sr = sext(r, bits);
+
+    if (op == "==") return make_bool(loc, context, l == r);
+    if (op == "!=") return make_bool(loc, context, l != r);
+    if (op == "<") return make_bool(loc, context, is_unsigned ? l < r : sl < sr);
+    if (op == ">") return make_bool(loc, context, is_unsigned ? l > r : sl > sr);
+    if (op == "<=") return make_bool(loc, context, is_unsigned ? l <= r : sl <= sr);
+    if (op == ">=") return make_bool(loc, context, is_unsigned ? l >= r : sl >= sr);
+    if (op == "&&") return make_bool(loc, context, l && r);
+    if (op == "||") return make_bool(loc, context, l || r);
+    if (op == "^^") return make_bool(loc, context, !l != !r);
+
+    Constant result{lhs.Type, 0, 0.0, lhs.Suffixed || rhs.Suffixed};
+    if (op == "+") result.Int = l + r;
+    else if (op == "-") result.Int = l - r;
+    else if (op == "*") result.Int = l * r;
+    else if (op == "&") result.Int = l & r;
+    else if (op == "|") result.Int = l | r;
+    else if (op == "^") result.Int = l ^ r;
+    else if ((op == "/" || op == "%") && is_unsigned)
+    {
+        if (!r) return {};
+        result.Int = op == "/" ? l / r : l % r;
+    }
+    else if (op == "/" || op == "%")
+    {
+        // division by zero and signed overflow are undefined, leave them to the program
+        const auto min = bits >= 64 ? std::numeric_limits<long long>::min() : -(1ll << (bits - 1));
+        if (!sr || (sl == min && sr == -1)) return {};
+        result.Int = static_cast<unsigned long long>(op == "/" ? sl / sr : sl % sr);
+    }
+    else if (op == "<<" || op == ">>" || op == ">>>")
+    {
+        // shifting by the width or more is poison
+        if (r >= bits) return {};
+        if (op == "<<") result.Int = l << r;
+        else if (op == ">>") result.Int = l >> r;
+        else result.Int = static_cast<unsigned long long>(sl >> r);
+    }
+    else return {};
+
+    result.Int = mask(result.Int, bits);
+    return make_literal(loc, result);
+}
+
+static Brewer::ExprPtr fold_float(const Brewer::SourceLocation& loc,
+                                  Brewer::Context& context,
+                                  const std::string& op,
+                                  const Constant& lhs,
+                                  const Constant& rhs)
+{
+    const auto l = lhs.Float;
+    const auto r = rhs.Float;
+
+    // the predefined comparisons are ordered, so they are false as soon as one side is nan
+    if (op == "==") return make_bool(loc, context, l == r);
+    if (op == "!=") return make_bool(loc, context, !std::isnan(l) && !std::isnan(r) && l != r);
+    if (op == "<") return make_bool(loc, context, l < r);
+    if (op == ">") return make_bool(loc, context, l > r);
+    if (op == "<=") return make_bool(loc, context, l <= r);
+    if (op == ">=") return make_bool(loc, context, l >= r);
+    if (op == "&&") return make_bool(loc, context, l != 0.0 && r != 0.0);
+    if (op == "||") return make_bool(loc, context, l != 0.0 || r != 0.0);
+    if (op == "^^") return make_bool(loc, context, (l != 0.0) != (r != 0.0));
+
+    Constant result{lhs.Type, 0, 0.0, lhs.Suffixed || rhs.Suffixed};
+    if (op == "+") result.Float = l + r;
+    else if (op == "-") result.Float = l - r;
+    else if (op == "*") result.Float = l * r;
+    else if (op == "/") result.Float = l / r;
+    else if (op == "%") result.Float = std::fmod(l, r);
+    else return {};
+
+    result.Float = round_to(result.Float, result.Type);
+    return make_literal(loc, result);
+}
+
+static Brewer::ExprPtr fold_binary(Brewer::Builder& builder, const Brewer::BinaryExpression& expr)
+{
+    if (!builder.IsPredefinedBinaryFn(expr.Operator)) return {};
+
+    Constant lhs, rhs;
+    if (!get_constant(expr.LHS.get(), lhs) || !get_constant(expr.RHS.get(), rhs)) return {};
+
+    if (lhs.Type != rhs.Type)
+    {
+        const auto type = Brewer::Type::GetHigherOrder(lhs.Type, rhs.Type);
+        if (!type || !cast(lhs, type) || !cast(rhs, type)) return {};
+    }
+
+    if (lhs.Type->IsInt()) return fold_int(expr.Location, builder.GetContext(), expr.Operator, lhs, rhs);
+    return fold_float(expr.Location, builder.GetContext(), expr.Operator, lhs, rhs);
+}
+
+static Brewer::ExprPtr fold_unary(Brewer::Builder& builder, const Brewer::UnaryExpression& expr)
+{
+    if (!builder.IsPredefinedUnaryFn(expr.Operator)) return {};
+
+    Constant operand;
+    if (!get_constant(expr.Operand.get(), operand)) return {};
+
+    const auto& op = expr.Operator;
+    if (operand.Type->IsInt())
+    {
+        const auto bits = operand.Type->GetSize();
+        if (op == "!") return make_bool(expr.Location, builder.GetContext(), !operand.Int);
+        if (op == "-") operand.Int = mask(0 - operand.Int, bits);
+        else if (op == "~") operand.Int = mask(~operand.Int, bits);
+        else return {};
+        return make_literal(expr.Location, operand);
+    }
+
+    if (op == "!") return make_bool(expr.Location, builder.GetContext(), operand.Float == 0.0);
+    if (op == "-") operand.Float = -operand.Float;
+    else return {};
+    return make_literal(expr.Location, operand);
+}
+
+Brewer::ExprPtr Brewer::Parser::Fold(ExprPtr expr)
+{
+    if (const auto binary = dynamic_cast<BinaryExpression*>(expr.get()))
+    {
+        if (auto folded = fold_binary(m_Builder, *binary)) return folded;
+        return expr;
+    }
+
+    if (const auto unary = dynamic_cast<UnaryExpression*>(expr.get()))
+    {
+        if (auto folded = fold_unary(m_Builder, *unary)) return folded;
+        return expr;
+    }
+
+    return expr;
+}
@@ -1,6 +1,9 @@
+#include <cmath>
+#include <limits>
 #include <Brewer/AST.hpp>
 #include <Brewer/Builder.hpp>
 #include <Brewer/Parser.hpp>
+#include <Brewer/Type.hpp>
 #include <Brewer/Value.hpp>
 
 Brewer::ExprPtr Brewer::Parser::ParseBinary()
@@ -12,7 +15,7 @@ Brewer::ExprPtr Brewer::Parser::ParseBinary()
 
 static int get_precedence(const std::string& op)
 {
-    static std::map<std::string, int> precedences{
+    static const std::map<std::string, int> precedences{
         {"=", 0},
         {"<<=", 0},
         {">>=", 0},
@@ -27,6 +30,7 @@ static int get_precedence(const std::string& op)
         {"^=", 0},
         {"&&", 1},
         {"||", 1},
+        {"^^", 1},
         {"<", 2},
         {">", 2},
         {"<=", 2},
@@ -46,10 +50,60 @@ static int get_precedence(const std::string& op)
         {"%", 6},
     };
 
-    if (precedences.count(op)) return precedences[op];
+    if (const auto it = precedences.find(op); it != precedences.end()) return it->second;
     return -1;
 }
 
+static bool is_unsuffixed(const Brewer::ExprPtr& expr)
+{
+    if (const auto i = dynamic_cast<const Brewer::ConstIntExpression*>(expr.get())) return !i->Suffixed;
+    if (const auto f = dynamic_cast<const Brewer::ConstFloatExpression*>(expr.get())) return !f->Suffixed;
+    return false;
+}
+
+// gives an unsuffixed literal the type of the other operand if its value fits, so e.g. 'x * 2' stays
+// at the width of 'x' instead of widening it to i64 and truncating the result again
+static void adapt_literal(Brewer::ExprPtr& literal, const Brewer::TypePtr& type)
+{
+    if (!type || type == literal->Type) return;
+
+    if (const auto i = dynamic_cast<Brewer::ConstIntExpression*>(literal.get()))
+    {
+        const auto from = i->Type->GetSize();
+        const auto value = from < 64
+                               ? static_cast<long long>(i->Value << (64 - from)) >> (64 - from)
+                               : static_cast<long long>(i->Value);
+        if (type->IsInt())
+        {
+            const auto bits = type->GetSize();
+            if (type->IsUnsigned() && (value < 0 || (bits < 64 && value >= 1ll << bits))) return;
+            if (bits == 1 && value != 0 && value != 1) return;
+            if (type->IsSigned() && bits > 1 && bits < 64 && (value < -(1ll << (bits - 1)) || value >= 1ll << (bits - 1)))
+                return;
+
+            i->Type = type;
+            if (bits < 64) i->Value &= (1ull << bits) - 1;
+            return;
+        }
+
+        if (!type->IsFloat32() && !type->IsFloat64()) return;
+
+        // only if the conversion is exact, so the literal keeps its value
+        const auto limit = type->IsFloat32() ? 1ll << 24 : 1ll << 53;
+        if (value < -limit || value > limit) return;
+
+        literal = std::make_unique<Brewer::ConstFloatExpression>(i->Location, type, static_cast<double>(value));
+        return;
+    }
+
+    if (const auto f = dynamic_cast<Brewer::ConstFloatExpression*>(literal.get()))
+    {
+        if (type->IsFloat64() || (type->IsFloat32() && (!std::isfinite(f->Value) ||
+            std::fabs(f->Value) <= std::numeric_limits<float>::max())))
+            f->Type = type;
+    }
+}
+
 Brewer::ExprPtr Brewer::Parser::ParseBinary(ExprPtr lhs, const int min_precedence)
 {
     while (At(TokenType_Operator) && get_precedence(Current().Value) >= min_precedence)
@@ -66,11 +120,17 @@ Brewer::ExprPtr Brewer::Parser::ParseBinary(ExprPtr lhs, const int min_precedenc
             if (!rhs) return {};
         }
 
+        if (is_unsuffixed(rhs) && !is_unsuffixed(lhs)) adapt_literal(rhs, lhs->Type);
+        else if (is_unsuffixed(lhs) && !is_unsuffixed(rhs)) adapt_literal(lhs, rhs->Type);
+
         TypePtr type;
         if (Value == "=") type = lhs->Type;
-        else m_Builder.GenBinaryFn(Value)(m_Builder, Value::Empty(lhs->Type), Value::Empty(rhs->Type), &type);
+        else if (const auto& lazy = m_Builder.GetLazyBinaryFn(Value))
+            lazy(m_Builder, *lhs, *rhs, &type);
+        else if (const auto& fn = m_Builder.GetBinaryFn(Value))
+            fn(m_Builder, Value::Empty(lhs->Type), Value::Empty(rhs->Type), &type);
 
-        lhs = std::make_unique<BinaryExpression>(Location, type, Value, std::move(lhs), std::move(rhs));
+        lhs = Fold(std::make_unique<BinaryExpression>(Location, type, Value, std::move(lhs), std::move(rhs)));
     }
 
     return lhs;
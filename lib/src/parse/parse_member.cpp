@@ -35,7 +35,7 @@ Brewer::ExprPtr Brewer::Parser::ParseMember(ExprPtr object)
             type = func ? func->GetType() : nullptr;
         }
         if (!type)
-            return std::cerr
+            return Err()
                 << "at " << Location << ": "
                 << "no member '" << member << "' in type " << struct_type->GetName()
                 << std::endl
@@ -2,15 +2,72 @@
 #include <Brewer/Builder.hpp>
 #include <Brewer/Context.hpp>
 #include <Brewer/Parser.hpp>
+#include <Brewer/Type.hpp>
 #include <Brewer/Util.hpp>
 #include <Brewer/Value.hpp>
 
+// a number may end in a suffix naming its type: i8 to i64, u or u8 to u64, and f16 to f64
+static Brewer::ExprPtr parse_number(Brewer::Context& context, const Brewer::Token& token, const int base)
+{
+    const auto& [Location, Type, Value] = token;
+
+    const auto pos = Value.find_first_of(Type == Brewer::TokenType_Hex ? "iu" : "iuf");
+    const auto digits = Value.substr(0, pos);
+    const auto suffix = pos == std::string::npos ? std::string() : Value.substr(pos);
+
+    if (suffix.empty())
+    {
+        if (Type == Brewer::TokenType_Float)
+            return std::make_unique<Brewer::ConstFloatExpression>(Location, context.GetFloat64Ty(), std::stod(digits));
+        return std::make_unique<Brewer::ConstIntExpression>(Location,
+                                                            context.GetInt64Ty(),
+                                                            std::stoull(digits, nullptr, base));
+    }
+
+    size_t width = 0;
+    if (suffix.size() == 1 && suffix[0] == 'u') width = 64;
+    else if (suffix.size() >= 2 && suffix.size() <= 3 && suffix.find_first_not_of("0123456789", 1) == std::string::npos)
+        width = std::stoul(suffix.substr(1));
+
+    Brewer::TypePtr type;
+    if (suffix[0] == 'f') type = context.GetFloatNTy(width);
+    else if (suffix[0] == 'u' && Type != Brewer::TokenType_Float) type = context.GetUIntNTy(width);
+    else if (Type != Brewer::TokenType_Float) type = context.GetIntNTy(width);
+    if (!type)
+        return Brewer::Err()
+            << "at " << Location << ": "
+            << "invalid literal suffix '" << suffix << "'"
+            << std::endl
+            << Brewer::ErrMark<Brewer::ExprPtr>();
+
+    if (type->IsFloat())
+    {
+        auto expr = std::make_unique<Brewer::ConstFloatExpression>(Location, type, std::stod(digits));
+        expr->Suffixed = true;
+        return expr;
+    }
+
+    // a signed literal has one bit less for its magnitude, a minus in front of it is a separate operator
+    const auto value = std::stoull(digits, nullptr, base);
+    const auto bits = suffix[0] == 'i' ? width - 1 : width;
+    if (bits < 64 && value >> bits)
+        return Brewer::Err()
+            << "at " << Location << ": "
+            << "literal " << digits << " does not fit into " << type->GetName()
+            << std::endl
+            << Brewer::ErrMark<Brewer::ExprPtr>();
+
+    auto expr = std::make_unique<Brewer::ConstIntExpression>(Location, type, value);
+    expr->Suffixed = true;
+    return expr;
+}
+
 Brewer::ExprPtr Brewer::Parser::ParsePrimary()
 {
     if (At(TokenType_EOF))
-        return std::cerr << "reached eof" << std::endl << ErrMark<ExprPtr>();
+        return Err() << "reached eof" << std::endl << ErrMark<ExprPtr>();
 
-    if (const auto& fn = m_ExprFnMap[Current().Value])
+    if (const auto& fn = GetExprFn(Current().Value))
         return fn(*this);
 
     auto loc = Current().Location;
@@ -27,8 +84,8 @@ Brewer::ExprPtr Brewer::Parser::ParsePrimary()
         auto [Location, Type, Value] = Skip();
         auto operand = ParseCall();
         TypePtr type;
-        m_Builder.GenUnaryFn(Value)(m_Builder, Value::Empty(operand->Type), &type);
-        return std::make_unique<UnaryExpression>(Location, type, Value, std::move(operand), true);
+        if (const auto& fn = m_Builder.GetUnaryFn(Value)) fn(m_Builder, Value::Empty(operand->Type), &type);
+        return Fold(std::make_unique<UnaryExpression>(Location, type, Value, std::move(operand), true));
     }
 
     if (At(TokenType_Name))
@@ -46,38 +103,25 @@ Brewer::ExprPtr Brewer::Parser::ParsePrimary()
             type = func ? func->GetType() : nullptr;
         }
         if (!type)
-            return std::cerr
+            return Err()
                 << "at " << Location << ": "
                 << "no such symbol '" << Value << "'"
                 << std::endl
                 << ErrMark<ExprPtr>();
         return std::make_unique<SymbolExpression>(Location, type, Value);
     }
-    if (At(TokenType_Bin))
-        return std::make_unique<ConstIntExpression>(loc,
-                                                    GetContext().GetInt64Ty(),
-                                                    std::stoull(Skip().Value, nullptr, 2));
-    if (At(TokenType_Oct))
-        return std::make_unique<ConstIntExpression>(loc,
-                                                    GetContext().GetInt64Ty(),
-                                                    std::stoull(Skip().Value, nullptr, 8));
-    if (At(TokenType_Dec))
-        return std::make_unique<ConstIntExpression>(loc,
-                                                    GetContext().GetInt64Ty(),
-                                                    std::stoull(Skip().Value, nullptr, 10));
-    if (At(TokenType_Hex))
-        return std::make_unique<ConstIntExpression>(loc,
-                                                    GetContext().GetInt64Ty(),
-                                                    std::stoull(Skip().Value, nullptr, 16));
-    if (At(TokenType_Float))
-        return std::make_unique<ConstFloatExpression>(loc, GetContext().GetFloat64Ty(), std::stold(Skip().Value));
+    if (At(TokenType_Bin)) return parse_number(GetContext(), Skip(), 2);
+    if (At(TokenType_Oct)) return parse_number(GetContext(), Skip(), 8);
+    if (At(TokenType_Dec)) return parse_number(GetContext(), Skip(), 10);
+    if (At(TokenType_Hex)) return parse_number(GetContext(), Skip(), 16);
+    if (At(TokenType_Float)) return parse_number(GetContext(), Skip(), 10);
     if (At(TokenType_Char))
         return std::make_unique<ConstCharExpression>(loc, GetContext().GetInt8Ty(), Skip().Value[0]);
     if (At(TokenType_String))
         return std::make_unique<ConstStringExpression>(loc, GetContext().GetInt8PtrTy(), Skip().Value);
 
     const auto [Location, Type, Value] = Skip();
-    return std::cerr
+    return Err()
         << "at " << Location << ": "
         << "unhandled token "
         << "'" << Value << "' "
@@ -33,7 +33,7 @@ Brewer::TypePtr Brewer::Parser::ParseType()
         auto [Location, Type, Value] = Expect(TokenType_Name);
         type = GetContext().GetType(Value);
         if (!type)
-            return std::cerr
+            return Err()
                 << "at " << Location << ": "
                 << "undefined type " << Value
                 << std::endl
@@ -50,10 +50,11 @@ Brewer::TypePtr Brewer::Parser::ParseType()
 
         if (NextIfAt("["))
         {
-            const auto length = dynamic_pointer_cast<ConstIntExpression>(ParseExpr());
+            const auto expr = ParseExpr();
+            const auto length = dynamic_cast<ConstIntExpression*>(expr.get());
             auto [Location, Type, Value] = Expect("]");
             if (!length)
-                return std::cerr
+                return Err()
                     << "at " << Location << ": "
                     << "array length must be a constant int"
                     << std::endl
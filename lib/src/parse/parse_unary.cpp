@@ -16,7 +16,7 @@ Brewer::ExprPtr Brewer::Parser::ParseUnary(ExprPtr operand)
     {
         auto [Location, Type, Value] = Skip();
         TypePtr type;
-        m_Builder.GenUnaryFn(Value)(m_Builder, Value::Empty(operand->Type), &type);
+        if (const auto& fn = m_Builder.GetUnaryFn(Value)) fn(m_Builder, Value::Empty(operand->Type), &type);
         operand = std::make_unique<UnaryExpression>(Location, type, Value, std::move(operand), false);
     }
 
@@ -30,11 +30,60 @@ Brewer::ExprFn& Brewer::Parser::ParseExprFn(const std::string& beg)
     return m_ExprFnMap[beg];
 }
 
+void Brewer::Parser::Inherit(const std::map<std::string, StmtFn>& stmt_fns,
+                             const std::map<std::string, ExprFn>& expr_fns)
+{
+    m_SharedStmtFnMap = &stmt_fns;
+    m_SharedExprFnMap = &expr_fns;
+}
+
+template <typename T>
+static const T& find_fn(const std::map<std::string, T>& local,
+                        const std::map<std::string, T>* shared,
+                        const std::string& key)
+{
+    static const T empty;
+    if (const auto it = local.find(key); it != local.end() && it->second) return it->second;
+    if (!shared) return empty;
+    if (const auto it = shared->find(key); it != shared->end()) return it->second;
+    return empty;
+}
+
+const Brewer::StmtFn& Brewer::Parser::GetStmtFn(const std::string& beg) const
+{
+    return find_fn(m_StmtFnMap, m_SharedStmtFnMap, beg);
+}
+
+const Brewer::ExprFn& Brewer::Parser::GetExprFn(const std::string& beg) const
+{
+    return find_fn(m_ExprFnMap, m_SharedExprFnMap, beg);
+}
+
 Brewer::Token& Brewer::Parser::Next()
 {
+    if (m_Fingerprinting)
+    {
+        m_Fingerprint += static_cast<char>(m_Token.Type);
+        m_Fingerprint += m_Token.Value;
+        m_Fingerprint += '\0';
+    }
+
+    PhaseScope phase(m_Builder.GetTiming(), Phase_Lex);
     return m_Token = NextToken();
 }
 
+void Brewer::Parser::BeginFingerprint()
+{
+    m_Fingerprinting = true;
+    m_Fingerprint.clear();
+}
+
+std::string Brewer::Parser::EndFingerprint()
+{
+    m_Fingerprinting = false;
+    return std::move(m_Fingerprint);
+}
+
 Brewer::Token& Brewer::Parser::Current()
 {
     return m_Token;
@@ -87,7 +136,7 @@ Brewer::Token Brewer::Parser::Expect(const TokenType type)
     if (At(type))
         return Skip();
     auto [Location, Type, Value] = Skip();
-    return std::cerr
+    return Err()
         << "at " << Location << ": "
         << "expected type " << type << ", got " << Type
         << std::endl
@@ -99,7 +148,7 @@ Brewer::Token Brewer::Parser::Expect(const std::string& value)
     if (At(value))
         return Skip();
     auto [Location, Type, Value] = Skip();
-    return std::cerr
+    return Err()
         << "at " << Location << ": "
         << "expected value '" << value << "', got '" << Value << "'"
         << std::endl
@@ -108,7 +157,7 @@ Brewer::Token Brewer::Parser::Expect(const std::string& value)
 
 Brewer::StmtPtr Brewer::Parser::Parse()
 {
-    if (const auto& fn = m_StmtFnMap[Current().Value])
+    if (const auto& fn = GetStmtFn(Current().Value))
         return fn(*this);
 
     return ParseExpr();
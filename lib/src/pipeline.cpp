@@ -3,6 +3,18 @@
 #include <Brewer/Context.hpp>
 #include <Brewer/Parser.hpp>
 #include <Brewer/Pipeline.hpp>
+#include <Brewer/Util.hpp>
+#include <fstream>
+#include <sstream>
+#include <llvm/Config/llvm-config.h>
+#include <llvm/Support/raw_ostream.h>
+#include <llvm/Support/SmallVectorMemoryBuffer.h>
+#include <llvm/Support/ThreadPool.h>
+#include <llvm/Support/TimeProfiler.h>
+
+#ifndef BREWER_VERSION
+#define BREWER_VERSION "unknown"
+#endif
 
 Brewer::Pipeline::Pipeline()
 {
@@ -32,6 +44,12 @@ Brewer::Pipeline& Brewer::Pipeline::GenUnaryFn(const std::string& operator_, con
     return *this;
 }
 
+Brewer::Pipeline& Brewer::Pipeline::GenLazyBinaryFn(const std::string& operator_, const LazyBinaryFn& fn)
+{
+    m_LazyBinaryFns[operator_] = fn;
+    return *this;
+}
+
 Brewer::Pipeline& Brewer::Pipeline::DumpAST(const bool mode)
 {
     m_DumpAST = mode;
@@ -50,43 +68,594 @@ Brewer::Pipeline& Brewer::Pipeline::DumpIR(const bool mode)
     return *this;
 }
 
+Brewer::Pipeline& Brewer::Pipeline::Optimize(const unsigned level)
+{
+    m_OptLevel = level;
+    return *this;
+}
+
+Brewer::Pipeline& Brewer::Pipeline::Streaming(const bool mode)
+{
+    m_Streaming = mode;
+    return *this;
+}
+
+Brewer::Pipeline& Brewer::Pipeline::MergeableStrings(const bool mode)
+{
+    m_MergeableStrings = mode;
+    return *this;
+}
+
+Brewer::Pipeline& Brewer::Pipeline::FastMath(const llvm::FastMathFlags flags)
+{
+    m_FastMathFlags = flags;
+    return *this;
+}
+
+Brewer::Pipeline& Brewer::Pipeline::FPContract(const llvm::FPOpFusion::FPOpFusionMode mode)
+{
+    m_FPContract = mode;
+    return *this;
+}
+
+Brewer::Pipeline& Brewer::Pipeline::Overflow(const OverflowMode mode)
+{
+    m_Overflow = mode;
+    return *this;
+}
+
+Brewer::Pipeline& Brewer::Pipeline::TailCalls(const TailCallMode mode)
+{
+    m_TailCalls = mode;
+    return *this;
+}
+
+Brewer::Pipeline& Brewer::Pipeline::Export(const std::string& name)
+{
+    m_Exports.insert(name);
+    return *this;
+}
+
+Brewer::Pipeline& Brewer::Pipeline::Lazy(const bool mode)
+{
+    m_Lazy = mode;
+    return *this;
+}
+
+Brewer::Pipeline& Brewer::Pipeline::Emit(const OutputKind kind, const std::string& filename)
+{
+    m_Outputs.push_back({kind, filename});
+    return *this;
+}
+
+Brewer::Pipeline& Brewer::Pipeline::Threads(const unsigned threads)
+{
+    m_Threads = threads ? threads : 1;
+    return *this;
+}
+
+Brewer::Pipeline& Brewer::Pipeline::LazyJIT(const bool mode)
+{
+    m_LazyJIT = mode;
+    return *this;
+}
+
+Brewer::Pipeline& Brewer::Pipeline::JITCache(const std::string& directory, const uint64_t max_size)
+{
+    m_JITCache = std::make_shared<Cache>(directory, max_size);
+    return *this;
+}
+
+Brewer::Pipeline& Brewer::Pipeline::CompileCache(const std::string& directory, const uint64_t max_size)
+{
+    m_CompileCache = std::make_shared<Cache>(directory, max_size);
+    return *this;
+}
+
+Brewer::Pipeline& Brewer::Pipeline::ConfigVersion(const std::string& version)
+{
+    m_ConfigVersion = version;
+    return *this;
+}
+
+Brewer::Pipeline& Brewer::Pipeline::Incremental(const bool mode)
+{
+    m_Incremental = mode;
+    return *this;
+}
+
+Brewer::Pipeline& Brewer::Pipeline::IncrementalPartitions(const unsigned partitions)
+{
+    m_IncrementalPartitions = partitions;
+    return *this;
+}
+
+Brewer::Pipeline& Brewer::Pipeline::TimeReport(const bool mode)
+{
+    m_TimeReport = mode;
+    return *this;
+}
+
+Brewer::Pipeline& Brewer::Pipeline::TimeTrace(const std::string& filename, const unsigned granularity_us)
+{
+    m_TimeTraceFilename = filename;
+    m_TimeTraceGranularity = granularity_us;
+    return *this;
+}
+
+Brewer::Timing Brewer::Pipeline::GetTiming()
+{
+    std::lock_guard lock(m_StatisticsMutex);
+    return m_Timing;
+}
+
+Brewer::Pipeline& Brewer::Pipeline::MemoryStats(const bool mode)
+{
+    m_MemoryStats = mode;
+    return *this;
+}
+
+Brewer::MemoryStatistics Brewer::Pipeline::GetMemoryStatistics()
+{
+    std::lock_guard lock(m_StatisticsMutex);
+    return m_MemoryStatistics;
+}
+
+Brewer::CompileCacheStatistics Brewer::Pipeline::GetCompileCacheStatistics() const
+{
+    return {m_CompileCacheHits, m_CompileCacheMisses, m_FragmentHits, m_FragmentMisses};
+}
+
+size_t Brewer::Pipeline::GetStreamingFallbacks() const
+{
+    return m_StreamingFallbacks;
+}
+
 void Brewer::Pipeline::Build(std::istream& stream, const std::string& input_filename)
+{
+    BuildToFiles(stream, input_filename, m_Outputs, m_Threads);
+}
+
+void Brewer::Pipeline::Build(std::istream& stream,
+                             const std::string& input_filename,
+                             const std::function<void(Builder&)>& emit,
+                             const bool report)
+{
+    // BuildMany starts the profiler on its workers itself and writes all their events at once
+    const auto trace = !m_TimeTraceFilename.empty() && !llvm::timeTraceProfilerEnabled();
+    if (trace) llvm::timeTraceProfilerInitialize(m_TimeTraceGranularity, "brewer");
+
+    Timing timing;
+    MemoryStatistics memory;
+    {
+        const auto before = GetThreadAllocations();
+
+        llvm::TimeTraceScope build_trace("Build", input_filename);
+        BuildModule(stream,
+                    input_filename,
+                    emit,
+                    m_TimeReport ? &timing : nullptr,
+                    m_MemoryStats ? &memory : nullptr);
+
+        const auto after = GetThreadAllocations();
+        for (size_t i = 0; i < after.size(); ++i)
+        {
+            memory.Allocations[i].Count = after[i].Count - before[i].Count;
+            memory.Allocations[i].Bytes = after[i].Bytes - before[i].Bytes;
+        }
+        memory.Builds = 1;
+        memory.PeakRSS = GetPeakRSS();
+    }
+
+    if (trace)
+    {
+        if (auto error = llvm::timeTraceProfilerWrite(m_TimeTraceFilename, input_filename))
+            Err() << "failed to write time trace: " << llvm::toString(std::move(error)) << std::endl;
+        llvm::timeTraceProfilerCleanup();
+    }
+
+    if (m_TimeReport && report) timing.Print(Out());
+
+    std::lock_guard lock(m_StatisticsMutex);
+    if (m_TimeReport) m_Timing.Merge(timing);
+    if (m_MemoryStats) m_MemoryStatistics.Merge(memory);
+}
+
+void Brewer::Pipeline::BuildModule(std::istream& stream,
+                                   const std::string& input_filename,
+                                   const std::function<void(Builder&)>& emit,
+                                   Timing* timing,
+                                   MemoryStatistics* memory)
 {
     Context context;
 
     Builder builder(context, m_ModuleID, input_filename);
+    builder.SetTiming(timing);
     Parser parser(builder, stream, input_filename);
 
-    for (const auto& [beg, fn] : m_StmtFns)
-        parser.ParseStmtFn(beg) = fn;
-    for (const auto& [beg, fn] : m_ExprFns)
-        parser.ParseExprFn(beg) = fn;
+    parser.Inherit(m_StmtFns, m_ExprFns);
+    builder.Inherit(m_BinaryFns, m_UnaryFns, m_LazyBinaryFns);
 
-    for (const auto& [op, fn] : m_BinaryFns)
-        builder.GenBinaryFn(op) = fn;
-    for (const auto& [op, fn] : m_UnaryFns)
-        builder.GenUnaryFn(op) = fn;
+    builder.SetOptLevel(m_OptLevel);
+    builder.SetStreaming(m_Streaming);
+    builder.SetMergeableStrings(m_MergeableStrings);
+    builder.SetFastMathFlags(m_FastMathFlags);
+    builder.SetFPContract(m_FPContract);
+    builder.SetOverflow(m_Overflow);
+    builder.SetTailCalls(m_TailCalls);
+    for (const auto& name : m_Exports)
+        builder.Export(name);
+    builder.RecordClosedFunctions(m_Incremental);
+    if (m_Incremental && m_CompileCache) builder.SetPartitionCache(m_CompileCache);
+
+    // the configuration is the same for all statements, only their tokens differ
+    const auto config = m_Incremental ? GetCompileCacheKey({}, {}, 0) : std::string();
 
     while (!parser.AtEOF())
     {
-        const auto ptr = parser.Parse();
+        const auto location = parser.Current().Location;
+        llvm::TimeTraceScope statement_trace("Statement",
+                                             [&]
+                                             {
+                                                 std::ostringstream detail;
+                                                 detail << location;
+                                                 return detail.str();
+                                             });
+
+        StmtPtr ptr;
+        std::string fingerprint;
+        {
+            PhaseScope phase(timing, Phase_Parse);
+            if (m_Incremental) parser.BeginFingerprint();
+            ptr = parser.Parse();
+            if (m_Incremental) fingerprint = parser.EndFingerprint();
+        }
         if (!ptr) continue;
 
-        if (m_DumpAST) std::cerr << ptr->Location << ": " << std::endl << ptr << std::endl;
-        ptr->GenIRNoVal(builder);
+        if (m_DumpAST) Out() << ptr->Location << ": " << std::endl << ptr << std::endl;
+
+        PhaseScope phase(timing,
+                         Phase_IRGen,
+                         [&]
+                         {
+                             std::ostringstream item;
+                             item << "statement at " << location;
+                             return item.str();
+                         });
+
+        // top level code goes into the global constructor
+        builder.IRBuilder().SetInsertPoint(&builder.GetGlobalCtor()->back());
+        const auto key = m_Incremental ? Cache::Hash({config, fingerprint}) : std::string();
+        if (auto name = m_Lazy ? ptr->GetDefinedName() : std::string(); !name.empty())
+        {
+            // a deferred body still comes from its fragment once it is required
+            DeferredFn generate;
+            if (m_Incremental)
+                generate = [this, key](Builder& target, const Statement& statement)
+                {
+                    GenIRIncremental(target, statement, key);
+                };
+            builder.Defer(name, std::move(ptr), std::move(generate));
+        }
+        else if (m_Incremental) GenIRIncremental(builder, *ptr, key);
+        else ptr->GenIRNoVal(builder);
     }
 
+    {
+        PhaseScope phase(timing, Phase_IRGen, [] { return std::string("deferred definitions"); });
+        builder.CloseDeferred();
+    }
     builder.CloseGlobals();
+    builder.Internalize();
+    builder.Optimize();
+    m_StreamingFallbacks += builder.GetStreamingFallbacks();
 
     if (m_DumpIR) builder.Dump();
-    if (m_EmitToFile) builder.EmitToFile(m_OutputFilename);
+
+    if (memory)
+    {
+        memory->Types = context.GetTypeCount();
+        for (const auto& function : builder.IRModule())
+        {
+            if (function.isDeclaration()) continue;
+            ++memory->Functions;
+            memory->BasicBlocks += function.size();
+            memory->Instructions += function.getInstructionCount();
+        }
+    }
+
+    emit(builder);
 }
 
 void Brewer::Pipeline::BuildAndEmit(std::istream& stream,
                                     const std::string& input_filename,
                                     const std::string& output_filename)
 {
-    m_EmitToFile = true;
-    m_OutputFilename = output_filename;
-    Build(stream, input_filename);
+    auto outputs = m_Outputs;
+    outputs.push_back({OutputKind_Object, output_filename});
+    BuildToFiles(stream, input_filename, outputs, m_Threads);
+}
+
+void Brewer::Pipeline::GenIRIncremental(Builder& builder, const Statement& statement, const std::string& key)
+{
+    if (const auto fragment = FindFragment(key); !fragment.empty())
+    {
+        statement.Declare(builder);
+        if (builder.LoadFragment(fragment))
+        {
+            ++m_FragmentHits;
+            return;
+        }
+    }
+    ++m_FragmentMisses;
+
+    const auto ctor = builder.GetGlobalCtor();
+    const auto blocks = ctor->size();
+    const auto insts = ctor->back().size();
+
+    builder.TakeClosedFunctions();
+    statement.GenIRNoVal(builder);
+    const auto functions = builder.TakeClosedFunctions();
+
+    // statements that add code to the global constructor cannot be replaced by their function bodies
+    if (functions.empty() || ctor->size() != blocks || ctor->back().size() != insts) return;
+
+    StoreFragment(key, builder.SaveFragment(functions));
+}
+
+std::string Brewer::Pipeline::FindFragment(const std::string& key)
+{
+    {
+        std::lock_guard lock(m_FragmentMutex);
+        if (const auto it = m_Fragments.find(key); it != m_Fragments.end()) return it->second;
+    }
+
+    if (!m_CompileCache) return {};
+    const auto buffer = m_CompileCache->Get(key + ".frag");
+    if (!buffer) return {};
+
+    std::string fragment = buffer->getBuffer().str();
+    std::lock_guard lock(m_FragmentMutex);
+    m_Fragments[key] = fragment;
+    return fragment;
+}
+
+void Brewer::Pipeline::StoreFragment(const std::string& key, std::string fragment)
+{
+    if (m_CompileCache) m_CompileCache->Put(key + ".frag", fragment);
+
+    std::lock_guard lock(m_FragmentMutex);
+    m_Fragments[key] = std::move(fragment);
+}
+
+bool Brewer::Pipeline::BuildToFiles(std::istream& stream,
+                                    const std::string& input_filename,
+                                    const std::vector<Output>& outputs,
+                                    const unsigned threads,
+                                    const bool report)
+{
+    if (!m_CompileCache || outputs.empty())
+    {
+        bool success = outputs.empty();
+        Build(stream,
+              input_filename,
+              [&](Builder& builder)
+              {
+                  if (!outputs.empty()) success = builder.EmitToFiles(outputs, threads);
+              },
+              report);
+        return success;
+    }
+
+    const std::string source{std::istreambuf_iterator(stream), {}};
+    const auto key = GetCompileCacheKey(source, input_filename, threads);
+    const auto partitions = m_Incremental ? m_IncrementalPartitions : 0;
+
+    // every file the outputs end up in, together with the key of its contents
+    std::vector<std::pair<std::string, std::string>> artifacts;
+    for (const auto& [kind, filename] : outputs)
+    {
+        const auto split = std::max(threads, partitions);
+        const auto partitioned = split > 1 && (kind == OutputKind_Object || kind == OutputKind_Assembly);
+        const auto count = partitioned ? split : 1;
+        for (unsigned i = 0; i < count; ++i)
+            artifacts.emplace_back(partitioned ? Builder::GetPartitionFilename(filename, i) : filename,
+                                   Cache::Hash({key, std::to_string(kind), std::to_string(i)}) + ".out");
+    }
+
+    std::vector<std::unique_ptr<llvm::MemoryBuffer>> buffers;
+    for (const auto& [filename, artifact] : artifacts)
+    {
+        auto buffer = m_CompileCache->Get(artifact);
+        if (!buffer) break;
+        buffers.push_back(std::move(buffer));
+    }
+
+    if (buffers.size() == artifacts.size())
+    {
+        ++m_CompileCacheHits;
+
+        bool success = true;
+        for (size_t i = 0; i < artifacts.size(); ++i)
+        {
+            std::error_code ec;
+            llvm::raw_fd_ostream dest(artifacts[i].first, ec);
+            if (ec)
+            {
+                Err() << "failed to open file: " << ec.message() << std::endl;
+                success = false;
+                continue;
+            }
+            dest << buffers[i]->getBuffer();
+        }
+        return success;
+    }
+
+    ++m_CompileCacheMisses;
+
+    // only clean builds are stored, a hit would otherwise swallow their diagnostics. the dumps and the time
+    // report are written to Out() instead, so they do not keep a build from being stored
+    std::ostringstream diagnostics;
+    const auto previous = ErrStream();
+    ErrStream() = &diagnostics;
+
+    std::istringstream source_stream(source);
+    bool success = false;
+    Build(source_stream,
+          input_filename,
+          [&](Builder& builder)
+          {
+              success = builder.EmitToFiles(outputs, threads, partitions);
+          },
+          report);
+
+    ErrStream() = previous;
+    Err() << diagnostics.str();
+
+    const auto clean = diagnostics.str().empty();
+    if (!success || !clean) return success;
+
+    for (const auto& [filename, artifact] : artifacts)
+    {
+        auto buffer = llvm::MemoryBuffer::getFile(filename, false, false);
+        if (!buffer) continue;
+        m_CompileCache->Put(artifact, (*buffer)->getBuffer());
+    }
+    return success;
+}
+
+std::string Brewer::Pipeline::GetCompileCacheKey(const llvm::StringRef source,
+                                                const std::string& input_filename,
+                                                const unsigned threads) const
+{
+    std::string registrations;
+    for (const auto& [beg, fn] : m_StmtFns)
+        registrations += "stmt " + beg + '\n';
+    for (const auto& [beg, fn] : m_ExprFns)
+        registrations += "expr " + beg + '\n';
+    for (const auto& [op, fn] : m_BinaryFns)
+        registrations += "binary " + op + '\n';
+    for (const auto& [op, fn] : m_UnaryFns)
+        registrations += "unary " + op + '\n';
+    for (const auto& [op, fn] : m_LazyBinaryFns)
+        registrations += "lazy " + op + '\n';
+
+    // everything that changes the generated code has to be part of the key
+    std::string options;
+    options += "opt " + std::to_string(m_OptLevel) + '\n';
+    options += "streaming " + std::to_string(m_Streaming) + '\n';
+    options += "mergeable-strings " + std::to_string(m_MergeableStrings) + '\n';
+    {
+        llvm::raw_string_ostream flags(options);
+        flags << "fast-math";
+        m_FastMathFlags.print(flags);
+        flags << "\nfp-contract " << m_FPContract << '\n';
+    }
+    options += "overflow " + std::to_string(m_Overflow) + '\n';
+    options += "tail-calls " + std::to_string(m_TailCalls) + '\n';
+    for (const auto& name : m_Exports)
+        options += "export " + name + '\n';
+    options += "lazy " + std::to_string(m_Lazy) + '\n';
+    options += "threads " + std::to_string(threads) + '\n';
+    options += "incremental " + std::to_string(m_Incremental) + '\n';
+    options += "incremental-partitions " + std::to_string(m_IncrementalPartitions) + '\n';
+
+    return Cache::Hash({
+        "brewer " BREWER_VERSION,
+        "llvm " LLVM_VERSION_STRING,
+        Builder::GetTargetKey(),
+        m_ConfigVersion,
+        registrations,
+        options,
+        m_ModuleID,
+        input_filename,
+        source,
+    });
+}
+
+std::unique_ptr<llvm::MemoryBuffer> Brewer::Pipeline::BuildToBuffer(std::istream& stream,
+                                                                    const std::string& input_filename,
+                                                                    const OutputKind kind)
+{
+    std::unique_ptr<llvm::MemoryBuffer> buffer;
+    Build(stream,
+          input_filename,
+          [&](Builder& builder)
+          {
+              llvm::SmallVector<char, 0> data;
+              if (!builder.EmitToBuffer(data, kind)) return;
+              buffer = std::make_unique<llvm::SmallVectorMemoryBuffer>(std::move(data), input_filename, false);
+          });
+    return buffer;
+}
+
+std::unique_ptr<Brewer::JIT> Brewer::Pipeline::BuildAndJIT(std::istream& stream, const std::string& input_filename)
+{
+    std::unique_ptr<JIT> jit;
+    Build(stream,
+          input_filename,
+          [&](Builder& builder)
+          {
+              auto instance = JIT::Create(m_LazyJIT, m_JITCache, m_FPContract);
+              if (!instance || !instance->Add(builder) || !instance->Initialize()) return;
+              jit = std::move(instance);
+          });
+    return jit;
+}
+
+std::vector<Brewer::BuildResult> Brewer::Pipeline::BuildMany(const std::vector<BuildInput>& inputs)
+{
+    std::vector<BuildResult> results(inputs.size());
+
+    const auto trace = !m_TimeTraceFilename.empty();
+    if (trace) llvm::timeTraceProfilerInitialize(m_TimeTraceGranularity, "brewer");
+
+    // every task gets its own context, builder and parser, so the files are independent of each other
+    // and only the registrations are shared. the files are the unit of parallelism here, so each of
+    // them is emitted on the thread that built it
+    llvm::ThreadPool pool(llvm::hardware_concurrency(m_Threads));
+    for (size_t i = 0; i < inputs.size(); ++i)
+    {
+        pool.async([&, i]
+        {
+            const auto& [filename, outputs] = inputs[i];
+            auto& result = results[i];
+            result.Filename = filename;
+
+            std::ostringstream diagnostics, output;
+            const auto previous = ErrStream();
+            const auto previous_output = OutStream();
+            ErrStream() = &diagnostics;
+            OutStream() = &output;
+
+            if (trace) llvm::timeTraceProfilerInitialize(m_TimeTraceGranularity, filename);
+
+            if (std::ifstream stream(filename); stream)
+            {
+                result.Success = BuildToFiles(stream, filename, outputs, 1, false);
+            }
+            else Err() << "failed to open '" << filename << "'" << std::endl;
+
+            // hands the events of this worker over to the profiler of the calling thread
+            if (trace) llvm::timeTraceProfilerFinishThread();
+
+            ErrStream() = previous;
+            OutStream() = previous_output;
+            result.Diagnostics = diagnostics.str();
+            result.Output = output.str();
+            result.Success = result.Success && result.Diagnostics.empty();
+        });
+    }
+    pool.wait();
+
+    if (trace)
+    {
+        if (auto error = llvm::timeTraceProfilerWrite(m_TimeTraceFilename, "brewer"))
+            Err() << "failed to write time trace: " << llvm::toString(std::move(error)) << std::endl;
+        llvm::timeTraceProfilerCleanup();
+    }
+
+    if (m_TimeReport) GetTiming().Print(Out());
+
+    return results;
 }
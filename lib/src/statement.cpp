@@ -7,6 +7,15 @@ Brewer::Statement::Statement(SourceLocation loc)
 
 Brewer::Statement::~Statement() = default;
 
+void Brewer::Statement::Declare(Builder&) const
+{
+}
+
+std::string Brewer::Statement::GetDefinedName() const
+{
+    return {};
+}
+
 std::ostream& Brewer::operator<<(std::ostream& stream, const StmtPtr& ptr)
 {
     return ptr->Dump(stream);
@@ -0,0 +1,104 @@
+#include <Brewer/Builder.hpp>
+#include <llvm/Bitcode/BitcodeReader.h>
+#include <llvm/Bitcode/BitcodeWriter.h>
+
+void Brewer::Builder::StreamFunction(llvm::Function* function)
+{
+    // the fragment has to carry the target, or the worker optimizes for no machine in particular
+    if (!GetTargetMachine()) return;
+
+    // the context of the module is not thread safe, so the worker gets the function as bitcode
+    auto fragment = SaveFragment({function});
+    if (!m_StreamPool) m_StreamPool = std::make_unique<llvm::ThreadPool>(llvm::hardware_concurrency(1));
+
+    m_Streamed.emplace_back(function,
+                            m_StreamPool->async(
+                                [this, level = m_OptLevel, fragment = std::move(fragment)]() -> std::string
+                                {
+                                    llvm::LLVMContext context;
+                                    auto module = llvm::parseBitcodeFile(
+                                        llvm::MemoryBufferRef(fragment, "fragment"),
+                                        context);
+                                    if (!module)
+                                    {
+                                        llvm::consumeError(module.takeError());
+                                        return {};
+                                    }
+
+                                    if (!m_StreamOptimizer || m_StreamOptimizer->GetLevel() != level)
+                                    {
+                                        m_StreamOptimizer.reset();
+                                        if (!m_StreamMachine) m_StreamMachine = CreateTargetMachine();
+                                        if (!m_StreamMachine) return {};
+                                        m_StreamOptimizer = std::make_unique<Optimizer>(level,
+                                            m_StreamMachine.get());
+                                    }
+                                    for (auto& f : **module)
+                                        m_StreamOptimizer->Run(f);
+
+                                    std::string result;
+                                    llvm::raw_string_ostream stream(result);
+                                    llvm::WriteBitcodeToFile(**module, stream);
+                                    stream.flush();
+                                    return result;
+                                }));
+}
+
+void Brewer::Builder::JoinStreamed()
+{
+    if (m_Streamed.empty()) return;
+
+    PhaseScope phase(m_Timing, Phase_Optimize, [] { return std::string("streamed functions"); });
+    for (const auto& [function, result] : m_Streamed)
+    {
+        // without a result the function keeps its body and is simplified with the rest of the module
+        const auto& fragment = result.get();
+        if (fragment.empty())
+        {
+            ++m_StreamingFallbacks;
+            continue;
+        }
+
+        // loading needs a declaration, so the body is parked in a placeholder until the result is in
+        const auto placeholder = llvm::Function::Create(function->getFunctionType(),
+                                                        llvm::GlobalValue::PrivateLinkage,
+                                                        "",
+                                                        *m_IRModule);
+        placeholder->splice(placeholder->end(), function);
+        for (size_t i = 0; i < function->arg_size(); ++i)
+            function->getArg(i)->replaceAllUsesWith(placeholder->getArg(i));
+
+        if (!LoadFragment(fragment))
+        {
+            function->splice(function->end(), placeholder);
+            for (size_t i = 0; i < function->arg_size(); ++i)
+                placeholder->getArg(i)->replaceAllUsesWith(function->getArg(i));
+            placeholder->eraseFromParent();
+            ++m_StreamingFallbacks;
+            continue;
+        }
+
+        placeholder->dropAllReferences();
+        placeholder->eraseFromParent();
+        m_StreamedFunctions.insert(function);
+
+        // the callees may have switched to fastcc while the worker was busy
+        for (auto& block : *function)
+            for (auto& inst : block)
+            {
+                const auto call = llvm::dyn_cast<llvm::CallBase>(&inst);
+                if (!call || !call->getCalledFunction()) continue;
+                call->setCallingConv(call->getCalledFunction()->getCallingConv());
+
+                const auto tail = llvm::dyn_cast<llvm::CallInst>(call);
+                if (tail && tail->isMustTailCall() && tail->getCallingConv() != function->getCallingConv())
+                    tail->setTailCallKind(llvm::CallInst::TCK_Tail);
+            }
+    }
+    m_Streamed.clear();
+}
+
+size_t Brewer::Builder::GetStreamingFallbacks() const
+{
+    return m_StreamingFallbacks;
+}
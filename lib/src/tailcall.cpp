@@ -0,0 +1,122 @@
+#include <set>
+#include <Brewer/Builder.hpp>
+#include <llvm/Analysis/CaptureTracking.h>
+#include <llvm/Analysis/ValueTracking.h>
+#include <llvm/IR/Instructions.h>
+#include <llvm/Transforms/Utils/BasicBlockUtils.h>
+
+// turns 'br %ret' in the predecessors of a block that only consists of 'phi' and 'ret phi' into a 'ret' of
+// the incoming value, as long as that value was computed in the predecessor itself
+static void duplicate_returns(llvm::Function& function)
+{
+    std::vector<llvm::BasicBlock*> worklist;
+    for (auto& block : function)
+        worklist.push_back(&block);
+
+    // a block may be queued again after it became a return itself, so deleted blocks are remembered
+    std::set<llvm::BasicBlock*> deleted;
+    while (!worklist.empty())
+    {
+        const auto block = worklist.back();
+        worklist.pop_back();
+        if (deleted.count(block)) continue;
+
+        const auto ret = llvm::dyn_cast<llvm::ReturnInst>(block->getTerminator());
+        if (!ret || !ret->getReturnValue()) continue;
+        const auto phi = llvm::dyn_cast<llvm::PHINode>(ret->getReturnValue());
+        if (!phi || phi->getParent() != block || phi->getNextNode() != ret) continue;
+
+        for (unsigned i = phi->getNumIncomingValues(); i-- > 0;)
+        {
+            const auto pred = phi->getIncomingBlock(i);
+            const auto value = llvm::dyn_cast<llvm::Instruction>(phi->getIncomingValue(i));
+            const auto br = llvm::dyn_cast<llvm::BranchInst>(pred->getTerminator());
+            if (!value || value->getParent() != pred || !br || br->isConditional()) continue;
+
+            llvm::ReturnInst::Create(function.getContext(), value, br);
+            br->eraseFromParent();
+            phi->removeIncomingValue(i, false);
+            worklist.push_back(pred);
+        }
+
+        if (!llvm::pred_empty(block)) continue;
+        deleted.insert(block);
+        llvm::DeleteDeadBlock(block);
+    }
+}
+
+static bool is_tail_call(const llvm::CallInst* call)
+{
+    if (call->isInlineAsm() || call->isMustTailCall()) return false;
+
+    // a tail call must not access the allocas of its caller
+    for (const auto& arg : call->args())
+        if (arg->getType()->isPointerTy() && llvm::isa<llvm::AllocaInst>(llvm::getUnderlyingObject(arg)))
+            return false;
+    return true;
+}
+
+// an alloca that escapes, e.g. stored to a global or passed to a call, may be reached by any callee
+static bool has_captured_alloca(const llvm::Function& function)
+{
+    for (const auto& block : function)
+        for (const auto& inst : block)
+            if (const auto alloca = llvm::dyn_cast<llvm::AllocaInst>(&inst))
+                if (llvm::PointerMayBeCaptured(alloca, true, true)) return true;
+    return false;
+}
+
+// musttail requires the caller and the callee to agree on the type and the calling convention
+static bool may_be_must_tail(const llvm::CallInst* call)
+{
+    const auto caller = call->getFunction();
+    return call->getFunctionType() == caller->getFunctionType()
+           && call->getCallingConv() == caller->getCallingConv()
+           && !caller->isVarArg();
+}
+
+// a call marked musttail before the calling convention of either side changed falls back to tail
+static void demote_must_tail(llvm::CallInst* call)
+{
+    if (call->isMustTailCall() && !may_be_must_tail(call)) call->setTailCallKind(llvm::CallInst::TCK_Tail);
+}
+
+void Brewer::Builder::MarkTailCalls(llvm::Function* function) const
+{
+    if (function->empty()) return;
+
+    // internal functions are only called directly from within the module, so they can use a calling
+    // convention that guarantees tail call optimization
+    if (m_TailCalls == TailCallMode_MustTail && function->hasLocalLinkage() && !function->hasAddressTaken())
+    {
+        function->setCallingConv(llvm::CallingConv::Fast);
+        for (const auto user : function->users())
+            if (const auto call = llvm::dyn_cast<llvm::CallBase>(user))
+            {
+                call->setCallingConv(llvm::CallingConv::Fast);
+                if (const auto inst = llvm::dyn_cast<llvm::CallInst>(call)) demote_must_tail(inst);
+            }
+    }
+
+    for (auto& block : *function)
+        for (auto& inst : block)
+            if (const auto call = llvm::dyn_cast<llvm::CallInst>(&inst)) demote_must_tail(call);
+
+    duplicate_returns(*function);
+
+    // no call may be a tail call while any of the allocas of the caller may be accessed by the callee
+    if (has_captured_alloca(*function)) return;
+
+    for (auto& block : *function)
+    {
+        const auto ret = llvm::dyn_cast<llvm::ReturnInst>(block.getTerminator());
+        if (!ret) continue;
+
+        const auto call = llvm::dyn_cast_or_null<llvm::CallInst>(ret->getPrevNode());
+        if (!call || !is_tail_call(call)) continue;
+        if (ret->getReturnValue() && ret->getReturnValue() != call) continue;
+
+        const auto must = m_TailCalls == TailCallMode_MustTail && may_be_must_tail(call);
+        call->setTailCallKind(must ? llvm::CallInst::TCK_MustTail : llvm::CallInst::TCK_Tail);
+    }
+}
@@ -0,0 +1,126 @@
+#include <algorithm>
+#include <iomanip>
+#include <Brewer/Timing.hpp>
+
+static thread_local Brewer::PhaseScope* current_scope = nullptr;
+
+static double to_ms(const Brewer::Timing::Clock::duration duration)
+{
+    return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+const char* Brewer::Timing::GetPhaseName(const Phase phase)
+{
+    switch (phase)
+    {
+    case Phase_Lex: return "lex";
+    case Phase_Parse: return "parse";
+    case Phase_IRGen: return "irgen";
+    case Phase_Optimize: return "optimize";
+    case Phase_Codegen: return "codegen";
+    default: return "?";
+    }
+}
+
+void Brewer::Timing::Add(const Phase phase, const Clock::duration duration)
+{
+    m_Phases[phase] += duration;
+}
+
+void Brewer::Timing::AddItem(std::string name, const Clock::duration duration)
+{
+    m_Items.emplace_back(std::move(name), duration);
+}
+
+void Brewer::Timing::Merge(const Timing& other)
+{
+    for (size_t i = 0; i < Phase_Count; ++i)
+        m_Phases[i] += other.m_Phases[i];
+    m_Items.insert(m_Items.end(), other.m_Items.begin(), other.m_Items.end());
+}
+
+Brewer::Timing::Clock::duration Brewer::Timing::Get(const Phase phase) const
+{
+    return m_Phases[phase];
+}
+
+Brewer::Timing::Clock::duration Brewer::Timing::GetTotal() const
+{
+    Clock::duration total{};
+    for (const auto& phase : m_Phases)
+        total += phase;
+    return total;
+}
+
+void Brewer::Timing::Print(std::ostream& stream, const size_t items) const
+{
+    const auto total = to_ms(GetTotal());
+
+    stream << "===-------------------------------------------------------------------------===" << std::endl;
+    stream << "                          brewer phase timing report" << std::endl;
+    stream << "===-------------------------------------------------------------------------===" << std::endl;
+
+    const auto flags = stream.flags();
+    stream << std::fixed << std::setprecision(3);
+    for (size_t i = 0; i < Phase_Count; ++i)
+    {
+        const auto ms = to_ms(m_Phases[i]);
+        stream
+            << "  " << std::left << std::setw(10) << GetPhaseName(static_cast<Phase>(i)) << std::right
+            << std::setw(12) << ms << " ms"
+            << std::setw(8) << std::setprecision(1) << (total > 0 ? ms * 100 / total : 0) << " %"
+            << std::setprecision(3) << std::endl;
+    }
+    stream << "  " << std::left << std::setw(10) << "total" << std::right << std::setw(12) << total << " ms"
+        << std::endl;
+
+    if (items && !m_Items.empty())
+    {
+        auto slowest = m_Items;
+        const auto count = std::min(items, slowest.size());
+        std::partial_sort(slowest.begin(),
+                          slowest.begin() + static_cast<ptrdiff_t>(count),
+                          slowest.end(),
+                          [](const auto& a, const auto& b) { return a.second > b.second; });
+
+        stream << std::endl << "  slowest:" << std::endl;
+        for (size_t i = 0; i < count; ++i)
+            stream << std::setw(14) << to_ms(slowest[i].second) << " ms  " << slowest[i].first << std::endl;
+    }
+
+    stream.flags(flags);
+}
+
+Brewer::Phase Brewer::PhaseScope::GetCurrentPhase()
+{
+    return current_scope ? current_scope->m_Phase : Phase_Count;
+}
+
+Brewer::PhaseScope::PhaseScope(Timing* timing, const Phase phase, const llvm::function_ref<std::string()> item)
+    : m_Timing(timing), m_Phase(phase)
+{
+    m_Parent = current_scope;
+    current_scope = this;
+
+    if (!m_Timing) return;
+
+    if (item) m_Item = item();
+    m_Start = Timing::Clock::now();
+}
+
+Brewer::PhaseScope::~PhaseScope()
+{
+    if (!m_Timing)
+    {
+        current_scope = m_Parent;
+        return;
+    }
+
+    const auto elapsed = Timing::Clock::now() - m_Start;
+    m_Timing->Add(m_Phase, elapsed);
+    if (!m_Item.empty()) m_Timing->AddItem(std::move(m_Item), elapsed);
+
+    // the enclosing scope only gets the time that was not spent in this one
+    if (m_Parent && m_Parent->m_Timing == m_Timing) m_Timing->Add(m_Parent->m_Phase, -elapsed);
+    current_scope = m_Parent;
+}
@@ -11,7 +11,10 @@ Brewer::TypePtr Brewer::Type::GetHigherOrder(const TypePtr& a, const TypePtr& b)
     {
         if (b->IsInt())
         {
-            if (a->GetSize() >= b->GetSize())
+            // at the same width, unsigned wins
+            if (a->GetSize() == b->GetSize())
+                return a->IsUnsigned() ? a : b;
+            if (a->GetSize() > b->GetSize())
                 return a;
             return b;
         }
@@ -48,7 +51,7 @@ Brewer::TypePtr Brewer::Type::GetHigherOrder(const TypePtr& a, const TypePtr& b)
             return b;
     }
 
-    return std::cerr
+    return Err()
         << "cannot determine higher order type of " << a << " and " << b
         << std::endl
         << ErrMark<TypePtr>();
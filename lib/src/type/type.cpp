@@ -18,8 +18,8 @@ Brewer::PointerTypePtr Brewer::Type::GetFunPtr(const FuncMode mode,
     return PointerType::Get(FunctionType::Get(mode, self, result, params, vararg));
 }
 
-Brewer::Type::Type(Context& context, std::string name, const TypeID id, const size_t size)
-    : m_Context(context), m_Name(std::move(name)), m_ID(id), m_Size(size)
+Brewer::Type::Type(Context& context, std::string name, const TypeID id, const size_t size, const bool is_signed)
+    : m_Context(context), m_Name(std::move(name)), m_ID(id), m_Size(size), m_Signed(is_signed)
 {
 }
 
@@ -98,6 +98,16 @@ bool Brewer::Type::IsInt64() const
     return IsInt(64);
 }
 
+bool Brewer::Type::IsSigned() const
+{
+    return m_ID == Type_Integer && m_Signed;
+}
+
+bool Brewer::Type::IsUnsigned() const
+{
+    return m_ID == Type_Integer && !m_Signed;
+}
+
 bool Brewer::Type::IsFloat(const size_t size) const
 {
     return m_ID == Type_Float && (!size || m_Size == size);
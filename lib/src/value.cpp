@@ -4,6 +4,7 @@
 #include <Brewer/Type.hpp>
 #include <Brewer/Util.hpp>
 #include <Brewer/Value.hpp>
+#include <llvm/IR/Function.h>
 
 Brewer::ValuePtr Brewer::Value::Empty(const TypePtr& type)
 {
@@ -31,17 +32,17 @@ Brewer::TypePtr Brewer::Value::GetType() const
 llvm::Type* Brewer::Value::GetIRType() const
 {
     if (!m_Builder)
-        return std::cerr << "empty value" << std::endl << ErrMark<llvm::Type*>();
+        return Err() << "empty value" << std::endl << ErrMark<llvm::Type*>();
     return m_IRType;
 }
 
 Brewer::LValuePtr Brewer::Value::Dereference() const
 {
     if (!m_Builder)
-        return std::cerr << "empty value" << std::endl << ErrMark<LValuePtr>();
+        return Err() << "empty value" << std::endl << ErrMark<LValuePtr>();
     if (const auto type = PointerType::From(m_Type))
         return LValue::Direct(*m_Builder, type->GetBase(), Get());
-    return std::cerr
+    return Err()
         << "cannot dereference non pointer type " << m_Type->GetName()
         << std::endl
         << ErrMark<LValuePtr>();
@@ -52,6 +53,46 @@ llvm::Value* Brewer::Value::Get() const
     return nullptr;
 }
 
+static llvm::Function* get_function(const Brewer::Value& value)
+{
+    if (const auto rvalue = dynamic_cast<const Brewer::RValue*>(&value))
+        if (const auto function = llvm::dyn_cast_or_null<llvm::Function>(rvalue->Get()))
+            return function;
+    return Brewer::Err()
+        << "value of type " << value.GetType()->GetName() << " is not a function"
+        << std::endl
+        << Brewer::ErrMark<llvm::Function*>();
+}
+
+bool Brewer::Value::AddFnAttr(const llvm::Attribute::AttrKind kind) const
+{
+    const auto function = get_function(*this);
+    if (!function) return false;
+    function->addFnAttr(kind);
+    return true;
+}
+
+bool Brewer::Value::AddParamAttr(const unsigned index, const llvm::Attribute::AttrKind kind) const
+{
+    const auto function = get_function(*this);
+    if (!function) return false;
+    if (index >= function->arg_size())
+        return Err()
+            << "function " << function->getName().str() << " has no parameter " << index
+            << std::endl
+            << ErrMark<bool>();
+    function->addParamAttr(index, kind);
+    return true;
+}
+
+bool Brewer::Value::SetMemoryEffects(const llvm::MemoryEffects effects) const
+{
+    const auto function = get_function(*this);
+    if (!function) return false;
+    function->setMemoryEffects(function->getMemoryEffects() & effects);
+    return true;
+}
+
 Brewer::RValuePtr Brewer::RValue::From(const ValuePtr& value)
 {
     return std::dynamic_pointer_cast<RValue>(value);